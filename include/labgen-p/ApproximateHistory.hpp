@@ -0,0 +1,132 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "HistoryStorage.hpp"
+#include "PixelFormat.hpp"
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * ApproximateHistory                                                     *
+     * ====================================================================== */
+
+    /**
+     * Approximation of the history whose memory does not depend on S. Instead
+     * of the S samples with the lowest keys, a pixel keeps a histogram of the
+     * keys of all its samples, with two buckets per power of two, and a
+     * running estimate of the median of each channel.
+     *
+     * A sample is admitted when its key falls in a bucket that does not
+     * exceed the one holding the S-th lowest key seen so far. The admitted
+     * samples update the estimates as a frugal median whose step grows by one
+     * every four moves in the same direction, and falls back to one when the
+     * estimate turns back. The 64 buckets cover every key, as the keys are
+     * sums over the window and grow with its area. With 8-bit BGR frames, a
+     * pixel costs 138 bytes.
+     *
+     * The samples of a bucket cannot be told apart, and those admitted before
+     * the threshold reached its final bucket are not forgotten, but only
+     * outweighed by the next ones: the background is thus an approximation of
+     * the one given by the full history. A pixel counts as improved when the
+     * key of the sample is below the bucket of the S-th lowest key.
+     */
+    template <typename Sample, size_t Channels>
+    class ApproximateHistory : public HistoryStorage {
+      protected:
+
+        static const size_t KEY_BUCKETS = 64;
+
+        /* Threshold of a pixel that has not seen S samples yet. */
+        static const uint8_t NO_THRESHOLD = KEY_BUCKETS;
+
+        static const int16_t MAX_RUN = 0x7FFF;
+
+        static const int RUN_SHIFT = 2;
+
+      protected:
+
+        size_t height;
+        size_t width;
+        uint32_t buffer_size;
+        int motion_scale;
+        bool inserted;
+        std::vector<uint16_t> key_counts;
+        std::vector<uint8_t> thresholds;
+        std::vector<Sample> estimates;
+        std::vector<int16_t> runs;
+
+      public:
+
+        ApproximateHistory(
+          size_t height,
+          size_t width,
+          size_t buffer_size,
+          int motion_scale = 1
+        );
+
+        virtual size_t insert(
+          const cv::Mat& quantities_of_motion,
+          const cv::Mat& current_frame,
+          PixelFormat format = PixelFormat::BGR24
+        );
+
+        virtual size_t insert_batch(
+          MatIterator quantities_of_motion,
+          MatIterator current_frames,
+          size_t batch_size,
+          PixelFormat format = PixelFormat::BGR24
+        );
+
+        virtual void median(cv::Mat& result, size_t size = ~0) const;
+
+        virtual bool empty() const;
+
+        virtual void clear();
+
+      protected:
+
+        bool insert_sample(size_t pixel, uint32_t key, const Sample* sample);
+
+        static size_t get_bucket(uint32_t key);
+    };
+
+    /* ====================================================================== *
+     * Instantiations                                                         *
+     * ====================================================================== */
+
+    typedef ApproximateHistory<uint8_t, 3>              ApproximateHistory8UC3;
+    typedef ApproximateHistory<uint8_t, 1>              ApproximateHistory8UC1;
+    typedef ApproximateHistory<uint16_t, 1>            ApproximateHistory16UC1;
+
+#define _NS_LABGEN_P_NS_INTERNALS_APPROXIMATE_HISTORY_TPP_
+#include "ApproximateHistory.tpp"
+#undef  _NS_LABGEN_P_NS_INTERNALS_APPROXIMATE_HISTORY_TPP_
+  } /* ns_internals */
+} /* ns_labgen_p */
@@ -0,0 +1,283 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _NS_LABGEN_P_NS_INTERNALS_APPROXIMATE_HISTORY_TPP_
+#error "ApproximateHistory.hpp must be included instead of ApproximateHistory.tpp"
+#else
+/* ========================================================================== *
+ * ApproximateHistory                                                         *
+ * ========================================================================== */
+
+template <typename Sample, size_t Channels>
+const uint8_t ApproximateHistory<Sample, Channels>::NO_THRESHOLD;
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+ApproximateHistory<Sample, Channels>::ApproximateHistory(
+  size_t height,
+  size_t width,
+  size_t buffer_size,
+  int motion_scale
+) :
+height(height),
+width(width),
+buffer_size(buffer_size),
+motion_scale(motion_scale),
+inserted(false),
+key_counts(height * width * KEY_BUCKETS, 0),
+thresholds(height * width, NO_THRESHOLD),
+estimates(height * width * Channels, 0),
+runs(height * width * Channels, 0) {
+  /* The counts saturate, which does not change the bucket of the S-th lowest
+   * key as long as S does not exceed the saturation.
+   */
+  if (buffer_size > 0xFFFF)
+    throw std::logic_error("The approximate history requires S <= 65535!");
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+size_t ApproximateHistory<Sample, Channels>::insert(
+  const cv::Mat& quantities_of_motion,
+  const cv::Mat& current_frame,
+  PixelFormat format
+) {
+  size_t changes = 0;
+
+  if (is_yuv420(format)) {
+    const uint8_t* chroma_planes = current_frame.ptr(height);
+    size_t chroma_stride;
+    size_t chroma_step;
+    size_t v_offset;
+
+    if (format == PixelFormat::I420) {
+      chroma_stride = current_frame.step / 2;
+      chroma_step = 1;
+      v_offset = (height / 2) * chroma_stride;
+    }
+    else {
+      chroma_stride = current_frame.step;
+      chroma_step = 2;
+      v_offset = 1;
+    }
+
+    /* As in PatchesHistory, only the three-channel instantiation is given
+     * 4:2:0 frames, whose samples are gathered from the planes.
+     */
+    Sample sample[3];
+
+    for (size_t y = 0; y < height; ++y) {
+      const uint8_t* luma_buffer = current_frame.ptr(y);
+      const uint8_t* u_buffer = chroma_planes + (y / 2) * chroma_stride;
+      const uint8_t* v_buffer = u_buffer + v_offset;
+      const int32_t* qt_buffer =
+        quantities_of_motion.ptr<int32_t>(y / motion_scale);
+
+      size_t pixel = y * width;
+
+      for (size_t x = 0; x < width; ++x, ++pixel) {
+        size_t chroma_offset = (x / 2) * chroma_step;
+
+        sample[0] = luma_buffer[x];
+        sample[1] = u_buffer[chroma_offset];
+        sample[2] = v_buffer[chroma_offset];
+
+        changes += insert_sample(pixel, qt_buffer[x / motion_scale], sample);
+      }
+    }
+  }
+  else {
+    /* The pixels may carry an unused fourth channel. */
+    size_t pixel_step = current_frame.elemSize() / sizeof(Sample);
+
+    for (size_t y = 0; y < height; ++y) {
+      const Sample* current_buffer = current_frame.ptr<Sample>(y);
+      const int32_t* qt_buffer =
+        quantities_of_motion.ptr<int32_t>(y / motion_scale);
+
+      size_t pixel = y * width;
+
+      for (size_t x = 0; x < width; ++x, ++pixel) {
+        changes +=
+          insert_sample(pixel, qt_buffer[x / motion_scale], current_buffer);
+        current_buffer += pixel_step;
+      }
+    }
+  }
+
+  inserted = true;
+
+  return changes;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+size_t ApproximateHistory<Sample, Channels>::insert_batch(
+  MatIterator quantities_of_motion,
+  MatIterator current_frames,
+  size_t batch_size,
+  PixelFormat format
+) {
+  size_t changes = 0;
+
+  /* The state of a pixel is small enough to stay in cache across frames. */
+  for (size_t k = 0; k < batch_size; ++k)
+    changes += insert(quantities_of_motion[k], current_frames[k], format);
+
+  return changes;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+void ApproximateHistory<Sample, Channels>::median(
+  cv::Mat& result,
+  size_t
+) const {
+  /* The estimates are those of S samples, whatever the requested size. */
+  const Sample* estimate = estimates.data();
+
+  for (int y = 0; y < result.rows; ++y) {
+    Sample* result_buffer = result.ptr<Sample>(y);
+
+    std::copy(estimate, estimate + result.cols * Channels, result_buffer);
+    estimate += result.cols * Channels;
+  }
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+bool ApproximateHistory<Sample, Channels>::empty() const {
+  /* Each frame is given to every pixel. */
+  return !inserted;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+void ApproximateHistory<Sample, Channels>::clear() {
+  std::fill(key_counts.begin(), key_counts.end(), 0);
+  std::fill(thresholds.begin(), thresholds.end(), NO_THRESHOLD);
+  std::fill(estimates.begin(), estimates.end(), 0);
+  std::fill(runs.begin(), runs.end(), 0);
+
+  inserted = false;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+bool ApproximateHistory<Sample, Channels>::insert_sample(
+  size_t pixel,
+  uint32_t key,
+  const Sample* sample
+) {
+  uint16_t* counts = key_counts.data() + pixel * KEY_BUCKETS;
+  uint8_t& threshold = thresholds[pixel];
+  size_t bucket = get_bucket(key);
+
+  if (counts[bucket] != 0xFFFF)
+    ++counts[bucket];
+
+  /* Until the S-th key is known, every sample improves the history, and then
+   * only the ones below its bucket.
+   */
+  bool improved = (bucket < threshold);
+
+  /* The threshold is the lowest bucket reaching S samples with the ones below
+   * it, and can only be lowered by a sample below it.
+   */
+  if (bucket < threshold) {
+    uint32_t cumulated = 0;
+
+    for (size_t b = 0; b < threshold; ++b) {
+      cumulated += counts[b];
+
+      if (cumulated >= buffer_size) {
+        threshold = b;
+        break;
+      }
+    }
+  }
+
+  if (bucket > threshold)
+    return false;
+
+  Sample* estimate = estimates.data() + pixel * Channels;
+  int16_t* run = runs.data() + pixel * Channels;
+
+  /* A run counts the last moves of an estimate in the same direction, given
+   * by its sign, and sets the length of the next move in that direction.
+   */
+  for (size_t channel = 0; channel < Channels; ++channel) {
+    int32_t value = sample[channel];
+    int32_t current = estimate[channel];
+
+    if (run[channel] == 0) {
+      estimate[channel] = sample[channel];
+      run[channel] = 1;
+    }
+    else if (value > current) {
+      if (run[channel] < 0)
+        run[channel] = 1;
+      else if (run[channel] < MAX_RUN)
+        ++run[channel];
+
+      estimate[channel] =
+        std::min(current + 1 + ((run[channel] - 1) >> RUN_SHIFT), value);
+    }
+    else if (value < current) {
+      if (run[channel] > 0)
+        run[channel] = -1;
+      else if (run[channel] > -MAX_RUN)
+        --run[channel];
+
+      estimate[channel] =
+        std::max(current - 1 - ((-run[channel] - 1) >> RUN_SHIFT), value);
+    }
+  }
+
+  return improved;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+size_t ApproximateHistory<Sample, Channels>::get_bucket(uint32_t key) {
+  if (key < 2)
+    return key;
+
+  /* Two buckets per power of two: the position of the leading bit, then the
+   * bit that follows it.
+   */
+  size_t octave = 0;
+
+  for (size_t shift = 16; shift != 0; shift /= 2) {
+    if ((key >> octave) >= (1u << shift))
+      octave += shift;
+  }
+
+  return 2 * octave + ((key >> (octave - 1)) & 1);
+}
+#endif /* _NS_LABGEN_P_NS_INTERNALS_APPROXIMATE_HISTORY_TPP_ */
@@ -42,6 +42,23 @@ namespace ns_labgen_p {
       bool default_set;
       int32_t s_param;
       int32_t n_param;
+      int32_t motion_scale;
+      int32_t motion_threshold;
+      std::string detector;
+      int32_t reduction;
+      int32_t raw_height;
+      int32_t raw_width;
+      bool native_yuv;
+      bool subsample_chroma;
+      bool approximate_median;
+      int32_t stability_window;
+      double max_changes;
+      double max_motion;
+      bool coarse_to_fine;
+      int32_t output_every;
+      std::string output_stream;
+      std::string motion_cache;
+      double duplicate_tolerance;
       bool visualization;
       bool split_vis;
       bool record;
@@ -70,6 +87,40 @@ namespace ns_labgen_p {
 
       int32_t get_n_param() const;
 
+      int32_t get_motion_scale() const;
+
+      int32_t get_motion_threshold() const;
+
+      const std::string& get_detector() const;
+
+      int32_t get_reduction() const;
+
+      int32_t get_raw_height() const;
+
+      int32_t get_raw_width() const;
+
+      bool get_native_yuv() const;
+
+      bool get_subsample_chroma() const;
+
+      bool get_approximate_median() const;
+
+      int32_t get_stability_window() const;
+
+      double get_max_changes() const;
+
+      double get_max_motion() const;
+
+      bool get_coarse_to_fine() const;
+
+      int32_t get_output_every() const;
+
+      const std::string& get_output_stream() const;
+
+      const std::string& get_motion_cache() const;
+
+      double get_duplicate_tolerance() const;
+
       bool get_visualization() const;
 
       bool get_split_vis() const;
@@ -104,6 +155,32 @@ namespace ns_labgen_p {
 
       void parse_n_param();
 
+      void parse_motion_scale();
+
+      void parse_motion_threshold();
+
+      void parse_detector();
+
+      void parse_reduction();
+
+      void parse_raw_size();
+
+      void parse_native_yuv();
+
+      void parse_subsample_chroma();
+
+      void parse_approximate_median();
+
+      void parse_stop_when_stable();
+
+      void parse_coarse_to_fine();
+
+      void parse_output_every();
+
+      void parse_motion_cache();
+
+      void parse_skip_duplicates();
+
       void parse_visualization();
 
       void parse_split_vis();
@@ -0,0 +1,210 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <opencv2/core/core.hpp>
+
+#include "BlockingQueue.hpp"
+#include "LaBGen_P.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * AsyncLaBGen_P                                                            *
+   * ======================================================================== */
+
+  /**
+   * Pipelined version of LaBGen_P. The motion stage (frame difference and
+   * filtering) of a frame runs on a dedicated thread while the history stage
+   * of the previous frame is in progress on another one. The buffers going
+   * from one stage to the other are recycled through a pool, whose size bounds
+   * the number of frames in flight.
+   *
+   * A submitted frame is shared with the pipeline, thus its content must not be
+   * modified before the corresponding future is ready. The first error raised
+   * by a stage is also reported by the next call to flush().
+   *
+   * The background snapshots are published by the thread of the history
+   * stage, so that they can be read at any time without flushing, or handed
+   * to the publication callback, which is then called by that thread. The
+   * same goes for the convergence, which lags behind the submitted frames by
+   * the frames in flight. The motion map and the quantities of motion of the
+   * last inserted frame can be copied at any time as well.
+   */
+  class AsyncLaBGen_P : protected LaBGen_P {
+    public:
+
+      using LaBGen_P::BackgroundSnapshot;
+
+      using LaBGen_P::BackgroundSnapshotPtr;
+
+      using LaBGen_P::PublicationCallback;
+
+      using LaBGen_P::MotionCallback;
+
+      using LaBGen_P::Detector;
+
+    protected:
+
+      struct StageBuffers {
+        cv::Mat motion_map;
+        cv::Mat quantities_of_motion;
+      };
+
+      struct Job {
+        cv::Mat previous_frame;
+        cv::Mat precomputed;
+        cv::Mat frame;
+        PixelFormat format;
+        Repetition repetition;
+        StageBuffers buffers;
+        std::promise<void> done;
+      };
+
+      typedef ns_internals::BlockingQueue<Job>                       JobsQueue;
+      typedef ns_internals::BlockingQueue<StageBuffers>            BuffersPool;
+
+    protected:
+
+      JobsQueue motion_queue;
+      JobsQueue history_queue;
+      BuffersPool pool;
+      size_t pending;
+      std::mutex pending_mutex;
+      std::condition_variable pending_cond;
+      std::exception_ptr failure;
+      mutable std::mutex public_buffers_mutex;
+      std::thread motion_thread;
+      std::thread history_thread;
+
+    public:
+
+      AsyncLaBGen_P(
+        size_t height,
+        size_t width,
+        int32_t s,
+        int32_t n,
+        int32_t motion_scale = 1,
+        size_t depth = 2
+      );
+
+      AsyncLaBGen_P(const AsyncLaBGen_P&) = delete;
+
+      AsyncLaBGen_P& operator=(const AsyncLaBGen_P&) = delete;
+
+      virtual ~AsyncLaBGen_P();
+
+      std::future<void> submit(const cv::Mat& current_frame);
+
+      std::future<void> submit(
+        const cv::Mat& current_frame,
+        PixelFormat format
+      );
+
+      std::future<void> submit_pair(
+        const cv::Mat& previous_frame,
+        const cv::Mat& frame
+      );
+
+      std::future<void> submit_pair(
+        const cv::Mat& previous_frame,
+        const cv::Mat& frame,
+        PixelFormat format
+      );
+
+      std::future<void> submit_precomputed(
+        const cv::Mat& quantities,
+        const cv::Mat& frame,
+        PixelFormat format
+      );
+
+      void flush();
+
+      using LaBGen_P::subsample_chroma;
+
+      using LaBGen_P::approximate_median;
+
+      using LaBGen_P::threshold_motion;
+
+      using LaBGen_P::use_detector;
+
+      using LaBGen_P::skip_duplicates;
+
+      void generate_background(cv::Mat& background);
+
+      void update_background(cv::Mat& background);
+
+      using LaBGen_P::set_publication_period;
+
+      using LaBGen_P::get_publication_period;
+
+      using LaBGen_P::set_publication_callback;
+
+      using LaBGen_P::set_motion_callback;
+
+      using LaBGen_P::get_background_snapshot;
+
+      using LaBGen_P::monitor_convergence;
+
+      using LaBGen_P::has_converged;
+
+      using LaBGen_P::get_changed_pixels;
+
+      using LaBGen_P::get_skipped_frames;
+
+      using LaBGen_P::get_reused_frames;
+
+      using LaBGen_P::get_inserted_frames;
+
+      using LaBGen_P::get_height;
+
+      using LaBGen_P::get_width;
+
+      using LaBGen_P::get_s;
+
+      using LaBGen_P::get_n;
+
+      using LaBGen_P::get_motion_scale;
+
+      using LaBGen_P::get_motion_map;
+
+      using LaBGen_P::get_quantities_of_motion;
+
+      void copy_motion(cv::Mat& motion_map, cv::Mat& quantities) const;
+
+    protected:
+
+      std::future<void> enqueue(Job& job);
+
+      void motion_stage();
+
+      void history_stage();
+
+      void complete(Job& job, std::exception_ptr error = nullptr);
+  };
+} /* ns_labgen_p */
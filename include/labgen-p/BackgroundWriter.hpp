@@ -0,0 +1,111 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "BlockingQueue.hpp"
+#include "LaBGen_P.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * BackgroundWriter                                                         *
+   * ======================================================================== */
+
+  /**
+   * Writes the published backgrounds on a dedicated thread, so that the
+   * encoding and the I/O never stall the insertions. The snapshots are queued
+   * as they are published, and the queue is bounded: a writer that cannot
+   * keep up eventually blocks the inserting thread instead of dropping
+   * backgrounds.
+   *
+   * The backgrounds are either written as PNG images named after the number
+   * of inserted frames, or appended to a stream, as is (raw) or as the frames
+   * of a Y4M sequence, whose header is written with the first background. The
+   * Y4M frames are 4:4:4 YUV, or gray for gray backgrounds, with 8 bits.
+   *
+   * The first error raised by the writer stops it, and is reported by
+   * finish().
+   */
+  class BackgroundWriter {
+    public:
+
+      enum Format {
+        FORMAT_IMAGE,
+        FORMAT_RAW,
+        FORMAT_Y4M
+      };
+
+    protected:
+
+      typedef ns_internals::BlockingQueue<LaBGen_P::BackgroundSnapshotPtr>
+        SnapshotsQueue;
+
+    protected:
+
+      Format format;
+      std::string prefix;
+      std::ostream* stream;
+      std::atomic<size_t> written;
+      SnapshotsQueue queue;
+      std::exception_ptr failure;
+      cv::Mat converted;
+      std::vector<uint8_t> plane;
+      std::thread writing_thread;
+
+    public:
+
+      explicit BackgroundWriter(const std::string& prefix, size_t depth = 4);
+
+      BackgroundWriter(Format format, std::ostream& stream, size_t depth = 4);
+
+      BackgroundWriter(const BackgroundWriter&) = delete;
+
+      BackgroundWriter& operator=(const BackgroundWriter&) = delete;
+
+      virtual ~BackgroundWriter();
+
+      void write(const LaBGen_P::BackgroundSnapshotPtr& snapshot);
+
+      void finish();
+
+      size_t get_written() const;
+
+    protected:
+
+      void writing_loop();
+
+      void write_image(const LaBGen_P::BackgroundSnapshot& snapshot);
+
+      void write_raw(const cv::Mat& background);
+
+      void write_y4m(const cv::Mat& background);
+  };
+} /* ns_labgen_p */
@@ -0,0 +1,156 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "LaBGen_P.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * BatchRunner                                                              *
+   * ======================================================================== */
+
+  /**
+   * Processes many sequences in a single process, each sequence being a task
+   * of a WorkStealingPool. The LaBGen_P instances are reset and kept once a
+   * sequence is done, so that the histories are only allocated once per
+   * combination of dimensions and parameters in use at the same time. They
+   * can also be allocated beforehand with warm_up(). The number of idle
+   * instances can be bounded, the least recently used ones being freed first.
+   *
+   * The jobs are started by decreasing priority, and in their order of
+   * submission for a given priority: each task of the pool takes the first
+   * queued job when it starts, not the one it was submitted for. The callback
+   * of a job is called by the thread that processed it.
+   *
+   * A manifest holds one job per line: the input sequence, the path of the
+   * background to write, S, N and optionally the motion scale, separated by
+   * whitespace. Empty lines and lines starting with '#' are ignored.
+   */
+  class BatchRunner {
+    public:
+
+      struct Job {
+        std::string input;
+        std::string output;
+        int32_t s;
+        int32_t n;
+        int32_t motion_scale;
+      };
+
+      struct Result {
+        bool success;
+        std::string message;
+        size_t frames;
+        double queued_seconds;
+        double processing_seconds;
+      };
+
+      typedef std::function<void(const Job&, const Result&)>          Callback;
+
+    protected:
+
+      typedef std::chrono::steady_clock                                  Clock;
+
+      struct QueuedJob {
+        Job job;
+        int32_t priority;
+        uint64_t order;
+        Clock::time_point submission;
+        Callback callback;
+
+        bool operator<(const QueuedJob& rhs) const;
+      };
+
+      typedef std::priority_queue<QueuedJob>                         JobsQueue;
+
+      typedef std::tuple<size_t, size_t, int32_t, int32_t, int32_t> InstanceKey;
+      typedef std::unique_ptr<LaBGen_P>                             InstancePtr;
+      typedef std::pair<InstanceKey, InstancePtr>                  IdleInstance;
+
+      /* From the least to the most recently released. */
+      typedef std::list<IdleInstance>                                 Instances;
+
+    protected:
+
+      std::vector<Job> jobs;
+      JobsQueue queue;
+      uint64_t submitted;
+      Instances instances;
+      size_t max_idle;
+      size_t failures;
+      std::mutex mutex;
+      ns_internals::WorkStealingPool pool;
+
+    public:
+
+      explicit BatchRunner(size_t threads_count = 0);
+
+      void add(const Job& job);
+
+      void load_manifest(const std::string& path);
+
+      size_t run(std::ostream& log);
+
+      void submit(const Job& job, int32_t priority, Callback callback);
+
+      void wait();
+
+      Result process(const Job& job);
+
+      void warm_up(
+        size_t height,
+        size_t width,
+        int32_t s,
+        int32_t n,
+        int32_t motion_scale,
+        size_t count
+      );
+
+      void set_max_idle_instances(size_t count);
+
+      size_t get_threads_count() const;
+
+    protected:
+
+      static void check(const Job& job);
+
+      void dispatch();
+
+      InstancePtr acquire(const InstanceKey& key);
+
+      void release(const InstanceKey& key, InstancePtr instance);
+  };
+} /* ns_labgen_p */
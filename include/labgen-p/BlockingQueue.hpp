@@ -0,0 +1,82 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * BlockingQueue                                                          *
+     * ====================================================================== */
+
+    /**
+     * Bounded FIFO queue shared between threads. The producers are blocked
+     * while the queue is full, and the consumers are blocked while it is empty.
+     * Once closed, the remaining elements can still be popped, but any
+     * subsequent push is refused.
+     */
+    template <typename T>
+    class BlockingQueue {
+      protected:
+
+        std::deque<T> queue;
+        size_t capacity;
+        bool closed;
+        mutable std::mutex mutex;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+
+      public:
+
+        explicit BlockingQueue(size_t capacity = ~static_cast<size_t>(0));
+
+        BlockingQueue(const BlockingQueue&) = delete;
+
+        BlockingQueue& operator=(const BlockingQueue&) = delete;
+
+        bool push(const T& element);
+
+        bool push(T&& element);
+
+        bool pop(T& element);
+
+        bool try_pop(T& element);
+
+        void close();
+
+        bool is_closed() const;
+
+        size_t size() const;
+
+        bool empty() const;
+    };
+
+#define _NS_LABGEN_P_NS_INTERNALS_BLOCKING_QUEUE_TPP_
+#include "BlockingQueue.tpp"
+#undef  _NS_LABGEN_P_NS_INTERNALS_BLOCKING_QUEUE_TPP_
+  } /* ns_internals */
+} /* ns_labgen_p */
@@ -0,0 +1,133 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _NS_LABGEN_P_NS_INTERNALS_BLOCKING_QUEUE_TPP_
+#error "BlockingQueue.hpp must be included instead of BlockingQueue.tpp"
+#else
+/* ========================================================================== *
+ * BlockingQueue                                                              *
+ * ========================================================================== */
+
+template <typename T>
+BlockingQueue<T>::BlockingQueue(size_t capacity) :
+queue(),
+capacity(capacity),
+closed(false) {
+  if (capacity == 0)
+    throw std::logic_error("The capacity of a queue must be positive");
+}
+
+/******************************************************************************/
+
+template <typename T>
+bool BlockingQueue<T>::push(const T& element) {
+  T copy(element);
+  return push(std::move(copy));
+}
+
+/******************************************************************************/
+
+template <typename T>
+bool BlockingQueue<T>::push(T&& element) {
+  std::unique_lock<std::mutex> lock(mutex);
+  not_full.wait(lock, [this] { return closed || (queue.size() < capacity); });
+
+  if (closed)
+    return false;
+
+  queue.push_back(std::move(element));
+  lock.unlock();
+
+  not_empty.notify_one();
+  return true;
+}
+
+/******************************************************************************/
+
+template <typename T>
+bool BlockingQueue<T>::pop(T& element) {
+  std::unique_lock<std::mutex> lock(mutex);
+  not_empty.wait(lock, [this] { return closed || !queue.empty(); });
+
+  if (queue.empty())
+    return false;
+
+  element = std::move(queue.front());
+  queue.pop_front();
+  lock.unlock();
+
+  not_full.notify_one();
+  return true;
+}
+
+/******************************************************************************/
+
+template <typename T>
+bool BlockingQueue<T>::try_pop(T& element) {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  if (queue.empty())
+    return false;
+
+  element = std::move(queue.front());
+  queue.pop_front();
+  lock.unlock();
+
+  not_full.notify_one();
+  return true;
+}
+
+/******************************************************************************/
+
+template <typename T>
+void BlockingQueue<T>::close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+  }
+
+  not_empty.notify_all();
+  not_full.notify_all();
+}
+
+/******************************************************************************/
+
+template <typename T>
+bool BlockingQueue<T>::is_closed() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return closed;
+}
+
+/******************************************************************************/
+
+template <typename T>
+size_t BlockingQueue<T>::size() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return queue.size();
+}
+
+/******************************************************************************/
+
+template <typename T>
+bool BlockingQueue<T>::empty() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return queue.empty();
+}
+#endif /* _NS_LABGEN_P_NS_INTERNALS_BLOCKING_QUEUE_TPP_ */
@@ -0,0 +1,64 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * ColorDifferenceKernels                                                 *
+     * ====================================================================== */
+
+    /**
+     * SIMD kernels of the color frame differences, on a row of interleaved B,
+     * G, R pixels. The absolute differences of the bytes are deinterleaved
+     * into one register per channel with SSSE3 shuffles, and the norms are
+     * computed in the registers, with the rounding of the portable loops of
+     * FrameDifference.
+     *
+     * The kernels process the pixels by blocks of 16 and return the number of
+     * pixels written to the motion map, the caller handling the remaining
+     * ones. The processor is checked once at run time, so that the binaries
+     * do not need to be built for SSSE3: without it, or out of x86, the
+     * kernels write nothing and return 0.
+     */
+    class ColorDifferenceKernels {
+      public:
+
+        static bool is_supported();
+
+        static int difference_l1(
+          const unsigned char* current_buffer,
+          const unsigned char* previous_buffer,
+          int32_t* motion_map_buffer,
+          int cols
+        );
+
+        static int difference_l2(
+          const unsigned char* current_buffer,
+          const unsigned char* previous_buffer,
+          int32_t* motion_map_buffer,
+          int cols
+        );
+    };
+  } /* ns_internals */
+} /* ns_labgen_p */
@@ -0,0 +1,77 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+
+#include <opencv2/core/core.hpp>
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * ConvergenceMonitor                                                     *
+     * ====================================================================== */
+
+    /**
+     * Tells when the background stops changing, by checking it at the end of
+     * each window of frames. It has converged when, over the last window, the
+     * mean ratio of pixels whose history improved per frame, and the mean
+     * absolute difference between the background and the one of the previous
+     * check, in levels of the samples, do not exceed their thresholds.
+     */
+    class ConvergenceMonitor {
+      protected:
+
+        size_t pixels;
+        size_t window;
+        double max_changes;
+        double max_motion;
+        size_t frames;
+        size_t last_check;
+        size_t window_changes;
+        double changes_ratio;
+        double motion;
+        bool converged;
+        cv::Mat reference;
+
+      public:
+
+        ConvergenceMonitor(
+          size_t pixels,
+          size_t window,
+          double max_changes,
+          double max_motion
+        );
+
+        bool update(size_t count, size_t changes);
+
+        void check(cv::Mat& background);
+
+        void reset();
+
+        bool has_converged() const;
+
+        double get_changes_ratio() const;
+
+        double get_motion() const;
+    };
+  } /* ns_internals */
+} /* ns_labgen_p */
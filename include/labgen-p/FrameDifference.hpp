@@ -0,0 +1,199 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "ColorDifferenceKernels.hpp"
+#include "MotionDetector.hpp"
+#include "Utils.hpp"
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * Norms                                                                  *
+     * ====================================================================== */
+
+    /**
+     * Norms of the differences of the channels of a pixel: the term of each
+     * difference is summed over the channels, then the norm is taken from the
+     * mean of the terms, so that the motion map keeps the range of a gray one.
+     * The norms that are not linear are looked up in a table. The SIMD
+     * kernel of each norm computes the motion map of as many B, G, R pixels of
+     * a row as it can.
+     */
+    struct NormL1 {
+      static const bool TABULATED = false;
+      static const uint32_t MAX_TERM = 255;
+
+      static int32_t term(int32_t difference) {
+        return std::abs(difference);
+      }
+
+      static double norm(double mean) {
+        return mean;
+      }
+
+      static int difference_bgr(
+        const unsigned char* current_buffer,
+        const unsigned char* previous_buffer,
+        int32_t* motion_map_buffer,
+        int cols
+      ) {
+        return ColorDifferenceKernels::difference_l1(
+          current_buffer,
+          previous_buffer,
+          motion_map_buffer,
+          cols
+        );
+      }
+    };
+
+    struct NormL2 {
+      static const bool TABULATED = true;
+      static const uint32_t MAX_TERM = 255 * 255;
+
+      static int32_t term(int32_t difference) {
+        return difference * difference;
+      }
+
+      static double norm(double mean) {
+        return std::sqrt(mean);
+      }
+
+      static int difference_bgr(
+        const unsigned char* current_buffer,
+        const unsigned char* previous_buffer,
+        int32_t* motion_map_buffer,
+        int cols
+      ) {
+        return ColorDifferenceKernels::difference_l2(
+          current_buffer,
+          previous_buffer,
+          motion_map_buffer,
+          cols
+        );
+      }
+    };
+
+    /* ====================================================================== *
+     * FrameDifference                                                        *
+     * ====================================================================== */
+
+    /**
+     * Frame difference on Channels channels (1 for gray, 3 for BGR) with the
+     * given Norm. With a scale larger than 1, the conversion and the
+     * downscaling by block averaging are fused in a single pass over the input
+     * frame, and the motion map is computed at the reduced resolution. 16-bit
+     * frames are first reduced to 8 bits, and gray frames given to a color
+     * difference are replicated, which gives the same motion map as the gray
+     * difference.
+     *
+     * A single difference has the same norm whatever the norm, its absolute
+     * value. With three channels, the SIMD kernel of the norm deinterleaves
+     * the channels and computes the norms in the registers. The pixels it
+     * leaves, if any, go through portable loops: the sums of the terms are
+     * written to the motion map, then replaced by their norms, from a table
+     * built once if the norm is tabulated. The templates make all these
+     * choices at compile time, so that the per-pixel loops have no branch nor
+     * call.
+     */
+    template <size_t Channels, typename Norm>
+    class FrameDifference : public MotionDetector {
+      static_assert(
+        (Channels == 1) || (Channels == 3),
+        "The frame difference works on 1 or 3 channels"
+      );
+
+      protected:
+
+        /* Luma weights of cvtColor, in fixed point. */
+        static const uint32_t GRAY_SHIFT = 14;
+        static const uint32_t B_WEIGHT   = 1868;
+        static const uint32_t G_WEIGHT   = 9617;
+        static const uint32_t R_WEIGHT   = 4899;
+
+      protected:
+
+        int scale;
+        cv::Mat previous_frame;
+        cv::Mat converted_input;
+        cv::Mat reduced_depth;
+        std::vector<uint32_t> accumulator;
+        std::vector<uint8_t> norms;
+
+      public:
+
+        explicit FrameDifference(int scale = 1);
+
+        virtual void compute(
+          const cv::Mat& current_frame,
+          cv::Mat& motion_map
+        );
+
+        virtual void compute(
+          const cv::Mat& last_frame,
+          const cv::Mat& current_frame,
+          cv::Mat& motion_map
+        );
+
+        virtual void reset();
+
+        int get_scale() const;
+
+      protected:
+
+        static void sum_terms(
+          const unsigned char* current_buffer,
+          const unsigned char* previous_buffer,
+          int32_t* sums_buffer,
+          int cols
+        );
+
+        void convert(const cv::Mat& frame);
+
+        void downscale_gray(const cv::Mat& current_frame);
+
+        void downscale_color(const cv::Mat& current_frame);
+    };
+
+    /* ====================================================================== *
+     * Instantiations                                                         *
+     * ====================================================================== */
+
+    typedef FrameDifference<1, NormL1>                     FrameDifferenceC1L1;
+    typedef FrameDifference<3, NormL1>                     FrameDifferenceC3L1;
+    typedef FrameDifference<3, NormL2>                     FrameDifferenceC3L2;
+
+#define _NS_LABGEN_P_NS_INTERNALS_FRAME_DIFFERENCE_TPP_
+#include "FrameDifference.tpp"
+#undef  _NS_LABGEN_P_NS_INTERNALS_FRAME_DIFFERENCE_TPP_
+  } /* ns_internals */
+} /* ns_labgen_p */
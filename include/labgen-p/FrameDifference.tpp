@@ -0,0 +1,329 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _NS_LABGEN_P_NS_INTERNALS_FRAME_DIFFERENCE_TPP_
+#error "FrameDifference.hpp must be included instead of FrameDifference.tpp"
+#else
+/* ========================================================================== *
+ * FrameDifference                                                            *
+ * ========================================================================== */
+
+template <size_t Channels, typename Norm>
+FrameDifference<Channels, Norm>::FrameDifference(int scale) : scale(scale) {
+  if (scale < 1) {
+    throw std::logic_error(
+      "The scale of the frame difference must be positive"
+    );
+  }
+
+  /* Rounded norm of each possible sum of terms. */
+  if ((Channels > 1) && Norm::TABULATED) {
+    norms.resize(Channels * Norm::MAX_TERM + 1);
+
+    for (size_t sum = 0; sum < norms.size(); ++sum) {
+      norms[sum] = static_cast<uint8_t>(
+        Norm::norm(static_cast<double>(sum) / Channels) + 0.5
+      );
+    }
+  }
+}
+
+/******************************************************************************/
+
+template <size_t Channels, typename Norm>
+void FrameDifference<Channels, Norm>::compute(
+  const cv::Mat& current_frame,
+  cv::Mat& motion_map
+) {
+  if(current_frame.empty())
+    return;
+
+  convert(current_frame);
+
+  if (previous_frame.empty()) {
+    converted_input.copyTo(previous_frame);
+    return;
+  }
+
+  /* Locals, as the motion map could alias the members otherwise. */
+  int rows = converted_input.rows;
+  int cols = converted_input.cols;
+  const int32_t channels = Channels;
+  const uint8_t* norms_buffer = norms.data();
+
+  for (int y = 0; y < rows; ++y) {
+    const unsigned char* current_buffer  = converted_input.ptr(y);
+    const unsigned char* previous_buffer = previous_frame.ptr(y);
+    int32_t* motion_map_buffer = motion_map.ptr<int32_t>(y);
+
+    if (Channels == 1) {
+      for (int x = 0; x < cols; ++x) {
+        *(motion_map_buffer++) = std::abs(
+          static_cast<int32_t>(*(current_buffer++)) - *(previous_buffer++)
+        );
+      }
+
+      continue;
+    }
+
+    int done = Norm::difference_bgr(
+      current_buffer,
+      previous_buffer,
+      motion_map_buffer,
+      cols
+    );
+
+    sum_terms(
+      current_buffer + (channels * done),
+      previous_buffer + (channels * done),
+      motion_map_buffer + done,
+      cols - done
+    );
+
+    if (Norm::TABULATED) {
+      for (int x = done; x < cols; ++x)
+        motion_map_buffer[x] = norms_buffer[motion_map_buffer[x]];
+    }
+    else {
+      for (int x = done; x < cols; ++x) {
+        motion_map_buffer[x] =
+          (motion_map_buffer[x] + (channels / 2)) / channels;
+      }
+    }
+  }
+
+  converted_input.copyTo(previous_frame);
+}
+
+/******************************************************************************/
+
+template <size_t Channels, typename Norm>
+void FrameDifference<Channels, Norm>::compute(
+  const cv::Mat& last_frame,
+  const cv::Mat& current_frame,
+  cv::Mat& motion_map
+) {
+  if (last_frame.empty() || current_frame.empty())
+    return;
+
+  /* The given frame replaces the previous one, in the same buffer. */
+  convert(last_frame);
+  converted_input.copyTo(previous_frame);
+
+  compute(current_frame, motion_map);
+}
+
+/******************************************************************************/
+
+template <size_t Channels, typename Norm>
+void FrameDifference<Channels, Norm>::reset() {
+  /* The next frame is the first one again. */
+  previous_frame.release();
+}
+
+/******************************************************************************/
+
+template <size_t Channels, typename Norm>
+int FrameDifference<Channels, Norm>::get_scale() const {
+  return scale;
+}
+
+/******************************************************************************/
+
+template <size_t Channels, typename Norm>
+void FrameDifference<Channels, Norm>::sum_terms(
+  const unsigned char* current_buffer,
+  const unsigned char* previous_buffer,
+  int32_t* sums_buffer,
+  int cols
+) {
+  const int channels = Channels;
+
+  for (int x = 0; x < cols; ++x) {
+    int32_t sum = 0;
+
+    for (int c = 0; c < channels; ++c) {
+      sum += Norm::term(
+        static_cast<int32_t>(current_buffer[channels * x + c]) -
+        previous_buffer[channels * x + c]
+      );
+    }
+
+    sums_buffer[x] = sum;
+  }
+}
+
+/******************************************************************************/
+
+template <size_t Channels, typename Norm>
+void FrameDifference<Channels, Norm>::convert(const cv::Mat& frame) {
+  /* 16-bit frames are reduced to 8 bits, so that the motion map keeps the
+   * range expected by the quantities of motion.
+   */
+  const cv::Mat* input = &frame;
+
+  if (frame.depth() == CV_16U) {
+    Utils::reduce_depth(frame, reduced_depth);
+    input = &reduced_depth;
+  }
+
+  if (Channels == 1) {
+    if (scale > 1)
+      downscale_gray(*input);
+    else if (input->channels() == 4)
+      cv::cvtColor(*input, converted_input, CV_BGRA2GRAY);
+    else if (input->channels() != 1)
+      cv::cvtColor(*input, converted_input, CV_BGR2GRAY);
+    else
+      converted_input = *input;
+  }
+  else {
+    if (scale > 1)
+      downscale_color(*input);
+    else if (input->channels() == 4)
+      cv::cvtColor(*input, converted_input, CV_BGRA2BGR);
+    else if (input->channels() == 1)
+      cv::cvtColor(*input, converted_input, CV_GRAY2BGR);
+    else
+      converted_input = *input;
+  }
+}
+
+/******************************************************************************/
+
+template <size_t Channels, typename Norm>
+void FrameDifference<Channels, Norm>::downscale_gray(
+  const cv::Mat& current_frame
+) {
+  int rows = Utils::scaled_size(current_frame.rows, scale);
+  int cols = Utils::scaled_size(current_frame.cols, scale);
+  int channels = current_frame.channels();
+
+  converted_input.create(rows, cols, CV_8UC1);
+
+  accumulator.resize(cols);
+
+  for (int row = 0; row < rows; ++row) {
+    int min_y = row * scale;
+    int max_y = std::min(min_y + scale, current_frame.rows);
+
+    std::fill(accumulator.begin(), accumulator.end(), 0);
+
+    /* Weighted luma sums of the blocks of the current row of blocks. */
+    for (int y = min_y; y < max_y; ++y) {
+      const unsigned char* buffer = current_frame.ptr(y);
+
+      for (int col = 0; col < cols; ++col) {
+        int min_x = col * scale;
+        int max_x = std::min(min_x + scale, current_frame.cols);
+        uint32_t sum = 0;
+
+        if (channels >= 3) {
+          for (int x = min_x; x < max_x; ++x) {
+            const unsigned char* pixel = buffer + (channels * x);
+
+            sum +=
+              pixel[0] * B_WEIGHT +
+              pixel[1] * G_WEIGHT +
+              pixel[2] * R_WEIGHT ;
+          }
+        }
+        else {
+          for (int x = min_x; x < max_x; ++x)
+            sum += static_cast<uint32_t>(buffer[x]) << GRAY_SHIFT;
+        }
+
+        accumulator[col] += sum;
+      }
+    }
+
+    /* Rounded averages, border blocks being possibly partial. */
+    unsigned char* output = converted_input.ptr(row);
+
+    for (int col = 0; col < cols; ++col) {
+      uint32_t count =
+        (max_y - min_y) *
+        (std::min((col + 1) * scale, current_frame.cols) - col * scale);
+
+      output[col] = static_cast<unsigned char>(
+        (accumulator[col] + ((count << GRAY_SHIFT) >> 1)) /
+        (count << GRAY_SHIFT)
+      );
+    }
+  }
+}
+
+/******************************************************************************/
+
+template <size_t Channels, typename Norm>
+void FrameDifference<Channels, Norm>::downscale_color(
+  const cv::Mat& current_frame
+) {
+  int rows = Utils::scaled_size(current_frame.rows, scale);
+  int cols = Utils::scaled_size(current_frame.cols, scale);
+  int channels = current_frame.channels();
+
+  converted_input.create(rows, cols, CV_8UC3);
+
+  accumulator.resize(cols * 3);
+
+  for (int row = 0; row < rows; ++row) {
+    int min_y = row * scale;
+    int max_y = std::min(min_y + scale, current_frame.rows);
+
+    std::fill(accumulator.begin(), accumulator.end(), 0);
+
+    /* Sums of the channels of the blocks of the current row of blocks, the
+     * channel of a gray frame being replicated.
+     */
+    for (int y = min_y; y < max_y; ++y) {
+      const unsigned char* buffer = current_frame.ptr(y);
+
+      for (int col = 0; col < cols; ++col) {
+        int min_x = col * scale;
+        int max_x = std::min(min_x + scale, current_frame.cols);
+        uint32_t* sums = accumulator.data() + (3 * col);
+
+        for (int x = min_x; x < max_x; ++x) {
+          const unsigned char* pixel = buffer + (channels * x);
+
+          for (int c = 0; c < 3; ++c)
+            sums[c] += pixel[(channels >= 3) ? c : 0];
+        }
+      }
+    }
+
+    /* Rounded averages, border blocks being possibly partial. */
+    unsigned char* output = converted_input.ptr(row);
+
+    for (int col = 0; col < cols; ++col) {
+      uint32_t count =
+        (max_y - min_y) *
+        (std::min((col + 1) * scale, current_frame.cols) - col * scale);
+
+      for (int c = 0; c < 3; ++c) {
+        output[3 * col + c] = static_cast<unsigned char>(
+          (accumulator[3 * col + c] + (count >> 1)) / count
+        );
+      }
+    }
+  }
+}
+#endif /* _NS_LABGEN_P_NS_INTERNALS_FRAME_DIFFERENCE_TPP_ */
@@ -0,0 +1,79 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * FrameSignature                                                         *
+     * ====================================================================== */
+
+    /**
+     * Signature telling whether a frame repeats another one: a hash of its
+     * whole content for the exact duplicates, and the means of its blocks of
+     * BLOCK_SIZE x BLOCK_SIZE pixels for the near duplicates. The distance of
+     * two signatures is the largest difference between the means of two
+     * blocks, over all the channels, in levels of 8-bit samples.
+     *
+     * The rows of a row of blocks are summed column by column in a loop that
+     * the compiler vectorizes, before the columns are summed by blocks. The
+     * buffers are kept when another frame of the same size is signed.
+     */
+    class FrameSignature {
+      protected:
+
+        static const int BLOCK_SIZE = 16;
+
+      protected:
+
+        uint64_t hash;
+        int rows;
+        int cols;
+        int type;
+        std::vector<float> block_means;
+        std::vector<uint32_t> column_sums;
+
+      public:
+
+        FrameSignature();
+
+        void compute(const cv::Mat& frame);
+
+        void clear();
+
+        bool empty() const;
+
+        uint64_t get_hash() const;
+
+        double distance(const FrameSignature& other) const;
+
+      protected:
+
+        template <typename Sample>
+        void compute_means(const cv::Mat& frame, float level);
+    };
+  } /* ns_internals */
+} /* ns_labgen_p */
@@ -0,0 +1,96 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+#include "PixelFormat.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * FrameSource                                                              *
+   * ======================================================================== */
+
+  /**
+   * Sequential source of BGR frames. An empty matrix given to read() always
+   * receives a freshly allocated buffer, so that it can be kept by the caller.
+   * The frames can be delivered with their dimensions divided by a reduction
+   * factor (1, 2, 4 or 8), which some sources apply during decoding.
+   *
+   * The input "-" designates the standard input, which carries a Y4M stream,
+   * or raw BGR frames when their size is given. The input "shm:<name>"
+   * designates a SharedFrameRing, whose frames can also be BGRA.
+   *
+   * When asked to, the sources of 4:2:0 YUV or gray frames can deliver them
+   * without converting them to BGR. The layout of the frames is then given by
+   * get_pixel_format(), which is also how the sequences of single-channel
+   * images, always delivered gray, are recognized.
+   *
+   * Some sources give a random access to their frames: after seek(), read()
+   * gives the frame of the requested index. Only the sources that land on the
+   * exact frame are seekable, which excludes the videos decoded by OpenCV,
+   * whose codecs often seek to a nearby key frame.
+   */
+  class FrameSource {
+    public:
+
+      typedef std::unique_ptr<FrameSource>                      FrameSourcePtr;
+
+    public:
+
+      virtual ~FrameSource() {}
+
+      virtual bool read(cv::Mat& frame) = 0;
+
+      virtual int32_t get_height() const = 0;
+
+      virtual int32_t get_width() const = 0;
+
+      virtual PixelFormat get_pixel_format() const {
+        return PixelFormat::BGR24;
+      }
+
+      virtual bool is_seekable() const {
+        return false;
+      }
+
+      virtual size_t get_frames_count() const {
+        return 0;
+      }
+
+      virtual void seek(size_t) {
+        throw std::logic_error("This source has no random access!");
+      }
+
+      static FrameSourcePtr open(
+        const std::string& input,
+        int reduction = 1,
+        const cv::Size& raw_size = cv::Size(),
+        bool native_yuv = false
+      );
+  };
+} /* ns_labgen_p */
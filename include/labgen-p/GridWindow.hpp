@@ -40,11 +40,6 @@ namespace ns_labgen_p {
    * ======================================================================== */
 
   class GridWindow {
-    protected:
-
-      typedef Utils::ROIs                                                 ROIs;
-      typedef std::vector<std::string>                               TextCache;
-
     public:
 
       enum Interpolation {
@@ -55,10 +50,38 @@ namespace ns_labgen_p {
         LANCZOS = cv::INTER_LANCZOS4
       };
 
+    protected:
+
+      typedef Utils::ROIs                                                 ROIs;
+      typedef std::vector<std::string>                               TextCache;
+
+      /* Geometry of the last matrix displayed in a tile, along with the
+       * sampling tables of its resizing. For each column (row) of the tile,
+       * the tables hold the offsets of the two nearest columns (rows) of the
+       * source and the weight of the second one, in fixed point.
+       */
+      struct Tile {
+        cv::Size source_size;
+        int32_t source_type;
+        cv::Rect rect;
+        std::vector<int32_t> x_offsets;
+        std::vector<int32_t> x_weights;
+        std::vector<int32_t> y_offsets;
+        std::vector<int32_t> y_weights;
+        uint64_t revision;
+        bool rendered;
+      };
+
+      typedef std::vector<Tile>                                          Tiles;
+
+      class TileSampler;
+
     protected:
 
       static const double ADAPTIVE_SCALE_TERM;
 
+      static const int32_t WEIGHT_BITS = 11;
+
     protected:
 
       ROIs rois;
@@ -72,6 +95,8 @@ namespace ns_labgen_p {
       bool k_ratio;
       TextProperties::TextPropertiesPtr title_properties;
       TextCache title_cache;
+      Tiles tiles;
+      bool modified;
       cv::Mat buffer;
       static std::unordered_set<std::string> available_windows;
 
@@ -90,6 +115,12 @@ namespace ns_labgen_p {
 
       void display(const cv::Mat& mat, int32_t index = 0);
 
+      void display_if_changed(
+        const cv::Mat& mat,
+        int32_t index,
+        uint64_t revision
+      );
+
       void display(const cv::Mat& mat, int32_t row, int32_t col);
 
       void put_title(const std::string& title, int32_t index = 0);
@@ -111,5 +142,22 @@ namespace ns_labgen_p {
       Interpolation get_interpolation_algorithm() const;
 
       void set_interpolation_algorithm(Interpolation algorithm);
+
+    protected:
+
+      void render(const cv::Mat& mat, int32_t index);
+
+      void prepare(Tile& tile, const cv::Mat& mat, int32_t index);
+
+      void invalidate();
+
+      static void compute_sampling_table(
+        int32_t source_length,
+        int32_t length,
+        int32_t step,
+        Interpolation interpolation,
+        std::vector<int32_t>& offsets,
+        std::vector<int32_t>& weights
+      );
   };
 } /* ns_labgen_p */
@@ -20,12 +20,15 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <vector>
 
 #include <opencv2/core/core.hpp>
 
+#include "HistoryStorage.hpp"
+#include "PixelFormat.hpp"
 #include "Utils.hpp"
 
 namespace ns_labgen_p {
@@ -34,41 +37,70 @@ namespace ns_labgen_p {
      * HistoryMat                                                             *
      * ====================================================================== */
 
+    template <typename Sample, size_t Channels>
     class HistoryMat {
-        friend bool operator< (const HistoryMat& lhs, const HistoryMat& rhs);
-        friend bool operator<=(const HistoryMat& lhs, const HistoryMat& rhs);
-        friend bool operator==(const HistoryMat& lhs, const HistoryMat& rhs);
-        friend bool operator< (const HistoryMat& lhs, const uint32_t&   rhs);
-        friend bool operator<=(const HistoryMat& lhs, const uint32_t&   rhs);
-        friend bool operator==(const HistoryMat& lhs, const uint32_t&   rhs);
-        friend bool operator< (const uint32_t&   lhs, const HistoryMat& rhs);
-        friend bool operator<=(const uint32_t&   lhs, const HistoryMat& rhs);
-        friend bool operator==(const uint32_t&   lhs, const HistoryMat& rhs);
+        template <typename S, size_t C>
+        friend bool operator< (const HistoryMat<S, C>& lhs,
+                               const HistoryMat<S, C>& rhs);
+        template <typename S, size_t C>
+        friend bool operator<=(const HistoryMat<S, C>& lhs,
+                               const HistoryMat<S, C>& rhs);
+        template <typename S, size_t C>
+        friend bool operator==(const HistoryMat<S, C>& lhs,
+                               const HistoryMat<S, C>& rhs);
+        template <typename S, size_t C>
+        friend bool operator< (const HistoryMat<S, C>& lhs,
+                               const uint32_t&         rhs);
+        template <typename S, size_t C>
+        friend bool operator<=(const HistoryMat<S, C>& lhs,
+                               const uint32_t&         rhs);
+        template <typename S, size_t C>
+        friend bool operator==(const HistoryMat<S, C>& lhs,
+                               const uint32_t&         rhs);
+        template <typename S, size_t C>
+        friend bool operator< (const uint32_t&         lhs,
+                               const HistoryMat<S, C>& rhs);
+        template <typename S, size_t C>
+        friend bool operator<=(const uint32_t&         lhs,
+                               const HistoryMat<S, C>& rhs);
+        template <typename S, size_t C>
+        friend bool operator==(const uint32_t&         lhs,
+                               const HistoryMat<S, C>& rhs);
 
       protected:
 
-        uint8_t mat[3];
+        Sample mat[Channels];
         uint32_t positives;
 
       public:
 
-        HistoryMat(const unsigned char* mat, const uint32_t positives);
+        HistoryMat(const Sample* mat, const uint32_t positives);
 
         HistoryMat(const HistoryMat& copy);
 
         HistoryMat& operator=(const HistoryMat& copy);
 
-        uint8_t operator[](size_t i) const;
+        Sample operator[](size_t i) const;
     };
 
     /* ====================================================================== *
      * History                                                                *
      * ====================================================================== */
 
+    template <typename Sample, size_t Channels>
     class History {
       public:
 
-        typedef std::vector<HistoryMat>                             HistoryVec;
+        typedef std::vector<HistoryMat<Sample, Channels>>           HistoryVec;
+
+        /* A sample replacing one of the same key modifies the history without
+         * improving it.
+         */
+        enum Insertion {
+          INSERTION_REJECTED,
+          INSERTION_REPLACED,
+          INSERTION_IMPROVED
+        };
 
       protected:
 
@@ -83,45 +115,115 @@ namespace ns_labgen_p {
 
         const HistoryVec& operator*() const;
 
-        void insert(
+        Insertion insert(
           const int32_t* quantities_of_motion,
-          const unsigned char* current_frame
+          const Sample* current_frame
         );
 
-        void median(unsigned char* result, size_t size = ~0) const;
+        void median(Sample* result, size_t size = ~0) const;
 
         bool empty() const;
+
+        void clear();
     };
 
     /* ====================================================================== *
      * PatchesHistory                                                         *
      * ====================================================================== */
 
-    class PatchesHistory {
+    /**
+     * Full storage: each sample keeps the channels of its pixel. It is
+     * instantiated for 8-bit BGR (or YUV) frames, and for 8-bit and 16-bit
+     * single-channel frames, which thus cost a third of the memory and work.
+     * The pixels whose history was modified since the last median are marked,
+     * so that update_median() only computes them again.
+     */
+    template <typename Sample, size_t Channels>
+    class PatchesHistory : public HistoryStorage {
+      protected:
+
+        typedef std::vector<History<Sample, Channels>>       PatchesHistoryVec;
+
       protected:
 
-        typedef std::vector<History>                         PatchesHistoryVec;
+        static const size_t BATCH_TILE_SIZE = 256;
 
       protected:
 
         PatchesHistoryVec p_history;
+        std::vector<uint8_t> modified;
         Utils::ROIs rois;
+        int motion_scale;
 
       public:
 
-        PatchesHistory(const Utils::ROIs& rois, size_t buffer_size);
+        PatchesHistory(
+          const Utils::ROIs& rois,
+          size_t buffer_size,
+          int motion_scale = 1
+        );
+
+        virtual size_t insert(
+          const cv::Mat& quantities_of_motion,
+          const cv::Mat& current_frame,
+          PixelFormat format = PixelFormat::BGR24
+        );
 
-        void insert(
-          const cv::Mat& quantities_of_motion, const cv::Mat& current_frame
+        virtual size_t insert_batch(
+          MatIterator quantities_of_motion,
+          MatIterator current_frames,
+          size_t batch_size,
+          PixelFormat format = PixelFormat::BGR24
         );
 
-        void median(cv::Mat& result, size_t size = ~0) const;
+        virtual void median(cv::Mat& result, size_t size = ~0) const;
 
-        bool empty() const;
+        virtual void update_median(cv::Mat& result, size_t size = ~0);
+
+        virtual bool empty() const;
+
+        virtual void clear();
+
+      protected:
+
+        size_t insert_segment(
+          const cv::Mat& quantities_of_motion,
+          const cv::Mat& current_frame,
+          PixelFormat format,
+          int y,
+          int min_x,
+          int max_x
+        );
+
+        size_t insert_yuv420_segment(
+          const cv::Mat& quantities_of_motion,
+          const cv::Mat& current_frame,
+          PixelFormat format,
+          int y,
+          int min_x,
+          int max_x
+        );
+
+        static size_t record(
+          typename History<Sample, Channels>::Insertion insertion,
+          uint8_t& modified
+        );
     };
 
+    /* ====================================================================== *
+     * Instantiations                                                         *
+     * ====================================================================== */
+
+    typedef PatchesHistory<uint8_t, 3>                      PatchesHistory8UC3;
+    typedef PatchesHistory<uint8_t, 1>                      PatchesHistory8UC1;
+    typedef PatchesHistory<uint16_t, 1>                    PatchesHistory16UC1;
+
 #define _NS_LABGEN_P_NS_INTERNALS_HISTORY_IPP_
 #include "History.ipp"
 #undef  _NS_LABGEN_P_NS_INTERNALS_HISTORY_IPP_
+
+#define _NS_LABGEN_P_NS_INTERNALS_HISTORY_TPP_
+#include "History.tpp"
+#undef  _NS_LABGEN_P_NS_INTERNALS_HISTORY_TPP_
   } /* ns_internals */
 } /* ns_labgen_p */
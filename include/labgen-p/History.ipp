@@ -25,55 +25,91 @@
  * Operator(s) overloading                                                    *
  ******************************************************************************/
 
-inline bool operator<(const HistoryMat& lhs, const HistoryMat& rhs) {
+template <typename S, size_t C>
+inline bool operator<(
+  const HistoryMat<S, C>& lhs,
+  const HistoryMat<S, C>& rhs
+) {
   return lhs.positives < rhs.positives;
 }
 
 /******************************************************************************/
 
-inline bool operator<=(const HistoryMat& lhs, const HistoryMat& rhs) {
+template <typename S, size_t C>
+inline bool operator<=(
+  const HistoryMat<S, C>& lhs,
+  const HistoryMat<S, C>& rhs
+) {
   return lhs.positives <= rhs.positives;
 }
 
 /******************************************************************************/
 
-inline bool operator==(const HistoryMat& lhs, const HistoryMat& rhs) {
+template <typename S, size_t C>
+inline bool operator==(
+  const HistoryMat<S, C>& lhs,
+  const HistoryMat<S, C>& rhs
+) {
   return lhs.positives == rhs.positives;
 }
 
 /******************************************************************************/
 
-inline bool operator<(const HistoryMat& lhs, const uint32_t& rhs) {
+template <typename S, size_t C>
+inline bool operator<(
+  const HistoryMat<S, C>& lhs,
+  const uint32_t& rhs
+) {
   return lhs.positives < rhs;
 }
 
 /******************************************************************************/
 
-inline bool operator<=(const HistoryMat& lhs, const uint32_t& rhs) {
+template <typename S, size_t C>
+inline bool operator<=(
+  const HistoryMat<S, C>& lhs,
+  const uint32_t& rhs
+) {
   return lhs.positives <= rhs;
 }
 
 /******************************************************************************/
 
-inline bool operator==(const HistoryMat& lhs, const uint32_t& rhs) {
+template <typename S, size_t C>
+inline bool operator==(
+  const HistoryMat<S, C>& lhs,
+  const uint32_t& rhs
+) {
   return lhs.positives == rhs;
 }
 
 /******************************************************************************/
 
-inline bool operator<(const uint32_t& lhs, const HistoryMat& rhs) {
+template <typename S, size_t C>
+inline bool operator<(
+  const uint32_t& lhs,
+  const HistoryMat<S, C>& rhs
+) {
   return lhs < rhs.positives;
 }
 
 /******************************************************************************/
 
-inline bool operator<=(const uint32_t& lhs, const HistoryMat& rhs) {
+template <typename S, size_t C>
+inline bool operator<=(
+  const uint32_t& lhs,
+  const HistoryMat<S, C>& rhs
+) {
   return lhs <= rhs.positives;
 }
 
 /******************************************************************************/
 
-inline bool operator==(const uint32_t& lhs, const HistoryMat& rhs) {
+template <typename S, size_t C>
+inline bool operator==(
+  const uint32_t& lhs,
+  const HistoryMat<S, C>& rhs
+) {
   return lhs == rhs.positives;
 }
 #endif /* _NS_LABGEN_P_NS_INTERNALS_HISTORY_IPP_ */
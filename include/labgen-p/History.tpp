@@ -0,0 +1,491 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _NS_LABGEN_P_NS_INTERNALS_HISTORY_TPP_
+#error "History.hpp must be included instead of History.tpp"
+#else
+/* ========================================================================== *
+ * HistoryMat                                                                 *
+ * ========================================================================== */
+
+template <typename Sample, size_t Channels>
+HistoryMat<Sample, Channels>::HistoryMat(
+  const Sample* mat,
+  const uint32_t positives
+) :
+positives(positives) {
+  std::copy(mat, mat + Channels, this->mat);
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+HistoryMat<Sample, Channels>::HistoryMat(const HistoryMat& copy) :
+positives(copy.positives) {
+  std::copy(copy.mat, copy.mat + Channels, mat);
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+HistoryMat<Sample, Channels>& HistoryMat<Sample, Channels>::operator=(
+  const HistoryMat& copy
+) {
+  if (this != &copy) {
+    std::copy(copy.mat, copy.mat + Channels, mat);
+
+    positives = copy.positives;
+  }
+
+  return *this;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+inline Sample HistoryMat<Sample, Channels>::operator[](size_t i) const {
+  return mat[i];
+}
+
+/* ========================================================================== *
+ * History                                                                    *
+ * ========================================================================== */
+
+template <typename Sample, size_t Channels>
+History<Sample, Channels>::History(size_t buffer_size) :
+history(),
+buffer_size(buffer_size) {
+  history.reserve(buffer_size + 1);
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+typename History<Sample, Channels>::HistoryVec&
+History<Sample, Channels>::operator*() {
+  return history;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+const typename History<Sample, Channels>::HistoryVec&
+History<Sample, Channels>::operator*() const {
+  return history;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+typename History<Sample, Channels>::Insertion
+History<Sample, Channels>::insert(
+  const int32_t* quantities_of_motion,
+  const Sample* current_frame
+) {
+  const int32_t* qt_buffer = quantities_of_motion;
+  uint32_t positives = *(qt_buffer);
+
+  if (history.empty()) {
+    history.push_back(HistoryMat<Sample, Channels>(current_frame, positives));
+
+    return INSERTION_IMPROVED;
+  }
+
+  for (
+    typename HistoryVec::iterator it = history.begin(), end = history.end();
+    it != end;
+    ++it
+  ) {
+    if (positives <= (*it)) {
+      history.insert(
+        it,
+        HistoryMat<Sample, Channels>(current_frame, positives)
+      );
+
+      if (history.size() <= buffer_size)
+        return INSERTION_IMPROVED;
+
+      /* Replacing a sample of the same key does not improve the history. */
+      bool improved = positives < history.back();
+      history.erase(history.end() - 1);
+
+      return improved ? INSERTION_IMPROVED : INSERTION_REPLACED;
+    }
+  }
+
+  if (history.size() < buffer_size) {
+    history.push_back(HistoryMat<Sample, Channels>(current_frame, positives));
+
+    return INSERTION_IMPROVED;
+  }
+
+  return INSERTION_REJECTED;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+void History<Sample, Channels>::median(Sample* result, size_t size) const {
+  if (history.size() == 1 || size == 1) {
+    for (size_t channel = 0; channel < Channels; ++channel)
+      result[channel] = history[0][channel];
+
+    return;
+  }
+
+  /* Shared by all the histories of a thread, and grown to the largest one. */
+  static thread_local std::vector<Sample> buffer;
+
+  if (buffer.size() < buffer_size)
+    buffer.resize(buffer_size);
+
+  size_t _size = std::min(history.size(), size);
+  size_t middle = _size / 2;
+
+  for (size_t channel = 0; channel < Channels; ++channel) {
+    for (size_t num = 0; num < _size; ++num)
+      buffer[num] = history[num][channel];
+
+    typename std::vector<Sample>::iterator begin = buffer.begin();
+
+    if (_size & 1) {
+      std::nth_element(begin, begin + middle, begin + _size);
+
+      result[channel] = buffer[middle];
+    }
+    else {
+      std::nth_element(begin, begin + (middle - 1), begin + _size);
+      std::nth_element(begin + middle, begin + middle, begin + _size);
+
+      result[channel] = (
+        static_cast<int32_t>(buffer[middle - 1]) + buffer[middle]
+      ) / 2;
+    }
+  }
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+bool History<Sample, Channels>::empty() const {
+  return history.empty();
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+void History<Sample, Channels>::clear() {
+  history.clear();
+}
+
+/* ========================================================================== *
+ * PatchesHistory                                                             *
+ * ========================================================================== */
+
+template <typename Sample, size_t Channels>
+PatchesHistory<Sample, Channels>::PatchesHistory(
+  const Utils::ROIs& rois,
+  size_t buffer_size,
+  int motion_scale
+) :
+p_history(),
+modified(rois.size(), 1),
+rois(rois),
+motion_scale(motion_scale) {
+  p_history.reserve(rois.size());
+
+  for (size_t i = 0; i < rois.size(); ++i)
+    p_history.push_back(History<Sample, Channels>(buffer_size));
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+size_t PatchesHistory<Sample, Channels>::insert(
+  const cv::Mat& quantities_of_motion,
+  const cv::Mat& current_frame,
+  PixelFormat format
+) {
+  /* The chroma planes of a 4:2:0 frame follow its luma rows. */
+  int rows =
+    is_yuv420(format) ? (current_frame.rows * 2 / 3) : current_frame.rows;
+
+  size_t changes = 0;
+
+  for (int y = 0; y < rows; ++y) {
+    changes += insert_segment(
+      quantities_of_motion,
+      current_frame,
+      format,
+      y,
+      0,
+      current_frame.cols
+    );
+  }
+
+  return changes;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+size_t PatchesHistory<Sample, Channels>::insert_batch(
+  MatIterator quantities_of_motion,
+  MatIterator current_frames,
+  size_t batch_size,
+  PixelFormat format
+) {
+  size_t total = p_history.size();
+  size_t changes = 0;
+
+  /* The samples of a batch are given tile by tile to keep the histories of a
+   * tile in cache. The order of the samples of a pixel is the one of the batch,
+   * so that the result is the same as the one of sequential insertions.
+   */
+  for (size_t begin = 0; begin < total; begin += BATCH_TILE_SIZE) {
+    size_t end = std::min(begin + BATCH_TILE_SIZE, total);
+
+    for (size_t k = 0; k < batch_size; ++k) {
+      size_t cols = current_frames[k].cols;
+
+      /* A tile can span several rows. */
+      for (size_t i = begin; i < end;) {
+        int y = i / cols;
+        int min_x = i % cols;
+        int max_x = std::min(cols, min_x + (end - i));
+
+        changes += insert_segment(
+          quantities_of_motion[k],
+          current_frames[k],
+          format,
+          y,
+          min_x,
+          max_x
+        );
+
+        i += max_x - min_x;
+      }
+    }
+  }
+
+  return changes;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+void PatchesHistory<Sample, Channels>::median(
+  cv::Mat& result,
+  size_t size
+) const {
+  const History<Sample, Channels>* history = p_history.data();
+
+  for (int y = 0; y < result.rows; ++y) {
+    Sample* result_buffer = result.ptr<Sample>(y);
+
+    for (int x = 0; x < result.cols; ++x, result_buffer += Channels)
+      (history++)->median(result_buffer, size);
+  }
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+void PatchesHistory<Sample, Channels>::update_median(
+  cv::Mat& result,
+  size_t size
+) {
+  const History<Sample, Channels>* history = p_history.data();
+  uint8_t* flag = modified.data();
+
+  for (int y = 0; y < result.rows; ++y) {
+    Sample* result_buffer = result.ptr<Sample>(y);
+
+    for (int x = 0; x < result.cols; ++x, result_buffer += Channels) {
+      if (*flag) {
+        history->median(result_buffer, size);
+        *flag = 0;
+      }
+
+      ++history;
+      ++flag;
+    }
+  }
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+bool PatchesHistory<Sample, Channels>::empty() const {
+  for (const History<Sample, Channels>& h : p_history) {
+    if (h.empty())
+      return true;
+  }
+
+  return false;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+void PatchesHistory<Sample, Channels>::clear() {
+  for (History<Sample, Channels>& h : p_history)
+    h.clear();
+
+  std::fill(modified.begin(), modified.end(), 1);
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+size_t PatchesHistory<Sample, Channels>::insert_segment(
+  const cv::Mat& quantities_of_motion,
+  const cv::Mat& current_frame,
+  PixelFormat format,
+  int y,
+  int min_x,
+  int max_x
+) {
+  if (is_yuv420(format)) {
+    return insert_yuv420_segment(
+      quantities_of_motion,
+      current_frame,
+      format,
+      y,
+      min_x,
+      max_x
+    );
+  }
+
+  /* The rows of the frame may be padded, and its pixels may carry an unused
+   * fourth channel.
+   */
+  size_t pixel_step = current_frame.elemSize() / sizeof(Sample);
+  const Sample* current_buffer =
+    current_frame.ptr<Sample>(y) + (min_x * pixel_step);
+
+  /* Each quantity of motion is shared by a block of motion_scale x
+   * motion_scale pixels.
+   */
+  const int32_t* qt_buffer =
+    quantities_of_motion.ptr<int32_t>(y / motion_scale);
+
+  size_t offset = (static_cast<size_t>(y) * current_frame.cols) + min_x;
+  History<Sample, Channels>* history = p_history.data() + offset;
+  uint8_t* flag = modified.data() + offset;
+
+  size_t changes = 0;
+
+  if (motion_scale == 1) {
+    for (int x = min_x; x < max_x; ++x, current_buffer += pixel_step) {
+      changes +=
+        record((history++)->insert(qt_buffer + x, current_buffer), *flag++);
+    }
+  }
+  else {
+    for (int x = min_x; x < max_x; ++x, current_buffer += pixel_step) {
+      changes += record(
+        (history++)->insert(qt_buffer + (x / motion_scale), current_buffer),
+        *flag++
+      );
+    }
+  }
+
+  return changes;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+size_t PatchesHistory<Sample, Channels>::insert_yuv420_segment(
+  const cv::Mat& quantities_of_motion,
+  const cv::Mat& current_frame,
+  PixelFormat format,
+  int y,
+  int min_x,
+  int max_x
+) {
+  int height = current_frame.rows * 2 / 3;
+  const uint8_t* luma_buffer = current_frame.ptr(y);
+  const uint8_t* chroma_planes = current_frame.ptr(height);
+
+  /* The samples of the chroma row shared by two luma rows. */
+  const uint8_t* u_buffer;
+  const uint8_t* v_buffer;
+  size_t chroma_step;
+
+  if (format == PixelFormat::I420) {
+    size_t chroma_stride = current_frame.step / 2;
+
+    u_buffer = chroma_planes + (y / 2) * chroma_stride;
+    v_buffer = u_buffer + (height / 2) * chroma_stride;
+    chroma_step = 1;
+  }
+  else {
+    u_buffer = chroma_planes + (y / 2) * current_frame.step;
+    v_buffer = u_buffer + 1;
+    chroma_step = 2;
+  }
+
+  const int32_t* qt_buffer =
+    quantities_of_motion.ptr<int32_t>(y / motion_scale);
+
+  size_t offset = (static_cast<size_t>(y) * current_frame.cols) + min_x;
+  History<Sample, Channels>* history = p_history.data() + offset;
+  uint8_t* flag = modified.data() + offset;
+
+  /* The Y, U and V samples of a pixel are gathered from the planes, and are
+   * stored as the three channels of a BGR pixel would be. Only the
+   * three-channel instantiation is given 4:2:0 frames.
+   */
+  Sample sample[3];
+  size_t changes = 0;
+
+  for (int x = min_x; x < max_x; ++x) {
+    size_t chroma_offset = (x / 2) * chroma_step;
+
+    sample[0] = luma_buffer[x];
+    sample[1] = u_buffer[chroma_offset];
+    sample[2] = v_buffer[chroma_offset];
+
+    changes += record(
+      (history++)->insert(qt_buffer + (x / motion_scale), sample),
+      *flag++
+    );
+  }
+
+  return changes;
+}
+
+/******************************************************************************/
+
+template <typename Sample, size_t Channels>
+size_t PatchesHistory<Sample, Channels>::record(
+  typename History<Sample, Channels>::Insertion insertion,
+  uint8_t& modified
+) {
+  if (insertion == History<Sample, Channels>::INSERTION_REJECTED)
+    return 0;
+
+  modified = 1;
+
+  return insertion == History<Sample, Channels>::INSERTION_IMPROVED;
+}
+#endif /* _NS_LABGEN_P_NS_INTERNALS_HISTORY_TPP_ */
@@ -0,0 +1,82 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "PixelFormat.hpp"
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * HistoryStorage                                                         *
+     * ====================================================================== */
+
+    /**
+     * Storage of the samples of the history of every pixel, each sample being
+     * kept along with the quantity of motion (key) of its frame. The virtual
+     * calls are made once per frame, never per pixel. Clearing a storage keeps
+     * its allocations, so that it can be reused for another sequence.
+     *
+     * An insertion returns the number of pixels whose history has improved,
+     * i.e. which kept the inserted sample while not full, or dropped a sample
+     * of a higher key for it. It is summed over the frames of a batch.
+     *
+     * update_median() is given the result of the previous median, and may only
+     * compute again the pixels whose history was modified in the meantime.
+     */
+    class HistoryStorage {
+      public:
+
+        typedef std::vector<cv::Mat>::const_iterator               MatIterator;
+
+      public:
+
+        virtual ~HistoryStorage() {}
+
+        virtual size_t insert(
+          const cv::Mat& quantities_of_motion,
+          const cv::Mat& current_frame,
+          PixelFormat format = PixelFormat::BGR24
+        ) = 0;
+
+        virtual size_t insert_batch(
+          MatIterator quantities_of_motion,
+          MatIterator current_frames,
+          size_t batch_size,
+          PixelFormat format = PixelFormat::BGR24
+        ) = 0;
+
+        virtual void median(cv::Mat& result, size_t size = ~0) const = 0;
+
+        virtual void update_median(cv::Mat& result, size_t size = ~0) {
+          median(result, size);
+        }
+
+        virtual bool empty() const = 0;
+
+        virtual void clear() = 0;
+    };
+  } /* ns_internals */
+} /* ns_labgen_p */
@@ -0,0 +1,121 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "FrameSource.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * ImageSequenceSource                                                      *
+   * ======================================================================== */
+
+  /**
+   * Source reading a sequence of numbered images described by a printf-like
+   * pattern (e.g. in%06d.jpg), starting at index 0 or 1. The images are
+   * decoded in parallel by a pool of threads, and given back in order through
+   * a reorder buffer. The sequence ends at the first missing index.
+   *
+   * The images can be read in any order, the decoding restarting from the
+   * requested index after a seek. As the next seek may come after one or two
+   * images, the decoding only goes as far ahead as the number of images read
+   * in order since the last seek.
+   *
+   * With a reduction factor, JPEG images are decoded directly at the reduced
+   * size by the DCT-domain scaling of the decoder, when OpenCV provides it.
+   *
+   * A sequence whose first image has a single 8-bit or 16-bit channel (e.g.
+   * thermal or infrared) is delivered gray, in GRAY8 or GRAY16. The next
+   * images are converted to that format.
+   */
+  class ImageSequenceSource : public FrameSource {
+    protected:
+
+      typedef std::map<size_t, cv::Mat>                          ReorderBuffer;
+
+    protected:
+
+      std::string pattern;
+      int reduction;
+      size_t window;
+      size_t first_index;
+      mutable size_t frames_count;
+      int32_t height;
+      int32_t width;
+      PixelFormat format;
+      size_t next_decode;
+      size_t next_read;
+      size_t last_index;
+      size_t sequential_reads;
+      bool stopped;
+      ReorderBuffer reorder_buffer;
+      std::mutex mutex;
+      std::condition_variable decoded;
+      std::condition_variable consumed;
+      std::vector<std::thread> workers;
+
+    public:
+
+      explicit ImageSequenceSource(
+        const std::string& pattern,
+        int reduction = 1,
+        size_t threads = 0
+      );
+
+      virtual ~ImageSequenceSource();
+
+      virtual bool read(cv::Mat& frame);
+
+      virtual int32_t get_height() const;
+
+      virtual int32_t get_width() const;
+
+      virtual PixelFormat get_pixel_format() const;
+
+      virtual bool is_seekable() const;
+
+      virtual size_t get_frames_count() const;
+
+      virtual void seek(size_t index);
+
+      static bool is_pattern(const std::string& input);
+
+    protected:
+
+      std::string get_path(size_t index) const;
+
+      cv::Mat load(size_t index) const;
+
+      size_t get_readahead() const;
+
+      void decode();
+  };
+} /* ns_labgen_p */
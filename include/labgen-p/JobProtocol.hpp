@@ -0,0 +1,97 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "BatchRunner.hpp"
+
+struct sockaddr_un;
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * JobProtocol                                                              *
+   * ======================================================================== */
+
+  /**
+   * Framed protocol between LaBGen-P-daemon and its clients over a Unix
+   * domain socket. A client connects, sends a job request and receives its
+   * result once the job is done, on the same connection.
+   *
+   * A message is a 32-bit length in network byte order followed by that many
+   * bytes of "key=value" lines. A request holds the keys input, output, s, n,
+   * motion_scale and priority. A result holds the keys status ("ok" or
+   * "error"), message, frames, queued_ms and processing_ms.
+   *
+   * A server reading many connections at once can accumulate their bytes
+   * without blocking, and extract() the messages once they are complete.
+   */
+  class JobProtocol {
+    public:
+
+      typedef std::map<std::string, std::string>                        Message;
+
+    public:
+
+      static const uint32_t MAX_MESSAGE_SIZE = 1 << 16;
+
+    public:
+
+      static int listen(const std::string& path);
+
+      static int connect(const std::string& path);
+
+      static bool read(int socket, Message& message);
+
+      static void write(int socket, const Message& message);
+
+      static bool extract(std::string& received, Message& message);
+
+      static Message encode_job(const BatchRunner::Job& job, int32_t priority);
+
+      static BatchRunner::Job decode_job(
+        const Message& message,
+        int32_t& priority
+      );
+
+      static Message encode_result(const BatchRunner::Result& result);
+
+      static BatchRunner::Result decode_result(const Message& message);
+
+    protected:
+
+      static void parse(const std::string& payload, Message& message);
+
+      static void read_bytes(int socket, char* buffer, size_t size);
+
+      static void write_bytes(int socket, const char* buffer, size_t size);
+
+      static void get_address(const std::string& path, sockaddr_un& address);
+
+      static const std::string& get(
+        const Message& message,
+        const std::string& key
+      );
+  };
+} /* ns_labgen_p */
@@ -20,14 +20,26 @@
  */
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include <opencv2/core/core.hpp>
 
-#include "FrameDifferenceC1L1.hpp"
-#include "History.hpp"
+#include "ConvergenceMonitor.hpp"
+#include "FrameDifference.hpp"
+#include "FrameSignature.hpp"
+#include "HistoryStorage.hpp"
+#include "MaskQuantitiesMotion.hpp"
+#include "MotionDetector.hpp"
+#include "MotionMask.hpp"
+#include "PixelFormat.hpp"
 #include "QuantitiesMotion.hpp"
+#include "ThresholdedFrameDifference.hpp"
 
 namespace ns_labgen_p {
   /* ======================================================================== *
@@ -35,27 +47,202 @@ namespace ns_labgen_p {
    * ======================================================================== */
 
   class LaBGen_P {
+    public:
+
+      /* Background published while frames are inserted, which is never
+       * modified once published. The epoch counts the publications, and the
+       * matrix must not be used beyond the lifetime of the snapshot, as its
+       * buffer is recycled afterwards.
+       */
+      struct BackgroundSnapshot {
+        cv::Mat background;
+        uint64_t epoch;
+        size_t inserted_frames;
+      };
+
+      typedef std::shared_ptr<const BackgroundSnapshot> BackgroundSnapshotPtr;
+
+      /* Called by the inserting thread after each publication. */
+      typedef std::function<void(const BackgroundSnapshotPtr&)>
+        PublicationCallback;
+
+      /* Called by the inserting thread with the quantities of motion of each
+       * frame inserted into the history, in the order of insertion.
+       */
+      typedef std::function<void(const cv::Mat&)>              MotionCallback;
+
+      /* Frame differences computing the motion maps, on the luma (C1) or on
+       * the B, G, R channels (C3), with the L1 or L2 norm. The color ones are
+       * only used with color frames, the other frames falling back to C1L1.
+       */
+      enum Detector {
+        DETECTOR_C1L1,
+        DETECTOR_C3L1,
+        DETECTOR_C3L2
+      };
+
+    protected:
+
+      /* Space of the samples stored in the history, fixed by the first frame
+       * inserted, along with the storage of the history.
+       */
+      enum ColorSpace {
+        COLOR_SPACE_NONE,
+        COLOR_SPACE_BGR,
+        COLOR_SPACE_YUV,
+        COLOR_SPACE_GRAY,
+        COLOR_SPACE_GRAY16
+      };
+
+      /* Relation of a frame inserted alone with the previous ones. */
+      enum Repetition {
+        REPETITION_NONE,
+        REPETITION_NEAR,
+        REPETITION_EXACT
+      };
+
+    protected:
+
+      /* Buffer of a snapshot that no reader holds anymore, given back by the
+       * deleter of the snapshots when their last reference is released. The
+       * pool is shared with the deleter, as a reader can keep a snapshot
+       * beyond the lifetime of the instance.
+       */
+      struct SnapshotPool {
+        std::mutex mutex;
+        std::unique_ptr<BackgroundSnapshot> spare;
+      };
+
     protected:
 
       size_t height;
       size_t width;
       int32_t s;
       int32_t n;
-      ns_internals::FrameDifferenceC1L1 f_diff;
+      int32_t motion_scale;
+      Detector detector;
+      Detector allocated_detector;
+      std::unique_ptr<ns_internals::MotionDetector> motion_detector;
       cv::Mat motion_map;
       cv::Mat quantities_of_motion;
       ns_internals::QuantitiesMotion filter;
-      ns_internals::PatchesHistory history;
+      bool motion_thresholding;
+      ns_internals::ThresholdedFrameDifference t_diff;
+      ns_internals::MotionMask motion_mask;
+      ns_internals::MaskQuantitiesMotion mask_filter;
+      bool duplicates_skipping;
+      double duplicate_tolerance;
+      ns_internals::FrameSignature signature;
+      ns_internals::FrameSignature reference_signature;
+      uint64_t previous_hash;
+      bool reusable_quantities;
+      std::atomic<size_t> skipped_frames;
+      std::atomic<size_t> reused_frames;
+      std::unique_ptr<ns_internals::HistoryStorage> history;
+      bool chroma_subsampling;
+      bool median_approximation;
       bool first_frame;
+      ColorSpace color_space;
+      ColorSpace history_color_space;
+      std::vector<cv::Mat> batch_quantities;
+      size_t inserted_frames;
+      std::atomic<size_t> publication_period;
+      size_t last_publication;
+      uint64_t epoch;
+      mutable std::mutex publication_mutex;
+      BackgroundSnapshotPtr published_snapshot;
+      std::shared_ptr<SnapshotPool> snapshot_pool;
+      PublicationCallback publication_callback;
+      MotionCallback motion_callback;
+      cv::Mat median_background;
+      std::atomic<size_t> changed_pixels;
+      std::unique_ptr<ns_internals::ConvergenceMonitor> monitor;
+      std::atomic<bool> converged;
+      cv::Mat convergence_background;
 
     public:
 
-      LaBGen_P(size_t height, size_t width, int32_t s, int32_t n);
+      LaBGen_P(
+        size_t height,
+        size_t width,
+        int32_t s,
+        int32_t n,
+        int32_t motion_scale = 1
+      );
+
+      void subsample_chroma();
+
+      void approximate_median();
+
+      void threshold_motion(uint8_t threshold);
+
+      void use_detector(Detector detector);
+
+      void skip_duplicates(double tolerance = 0);
+
+      void reset();
+
+      void allocate_history(PixelFormat format);
 
       void insert(const cv::Mat& current_frame);
 
+      void insert(const cv::Mat& current_frame, PixelFormat format);
+
+      void insert(const uint8_t* data, size_t stride, PixelFormat format);
+
+      void insert_batch(const std::vector<cv::Mat>& frames);
+
+      void insert_batch(
+        const std::vector<cv::Mat>& frames,
+        PixelFormat format
+      );
+
+      void insert_pair(const cv::Mat& previous_frame, const cv::Mat& frame);
+
+      void insert_pair(
+        const cv::Mat& previous_frame,
+        const cv::Mat& frame,
+        PixelFormat format
+      );
+
+      void insert_precomputed(
+        const cv::Mat& quantities,
+        const cv::Mat& frame,
+        PixelFormat format
+      );
+
       void generate_background(cv::Mat& background) const;
 
+      void update_background(cv::Mat& background);
+
+      void set_publication_period(size_t period);
+
+      size_t get_publication_period() const;
+
+      void set_publication_callback(PublicationCallback callback);
+
+      void set_motion_callback(MotionCallback callback);
+
+      void publish_background();
+
+      BackgroundSnapshotPtr get_background_snapshot() const;
+
+      void monitor_convergence(
+        size_t window,
+        double max_changes = 0.05,
+        double max_motion = 0.5
+      );
+
+      bool has_converged() const;
+
+      size_t get_changed_pixels() const;
+
+      size_t get_skipped_frames() const;
+
+      size_t get_reused_frames() const;
+
+      size_t get_inserted_frames() const;
+
       size_t get_height() const;
 
       size_t get_width() const;
@@ -64,8 +251,45 @@ namespace ns_labgen_p {
 
       int32_t get_n() const;
 
+      int32_t get_motion_scale() const;
+
       const cv::Mat& get_motion_map() const;
 
       const cv::Mat& get_quantities_of_motion() const;
+
+    protected:
+
+      void check_frame(const cv::Mat& frame, PixelFormat format) const;
+
+      void fix_color_space(PixelFormat format);
+
+      void check_quantities_of_motion(const cv::Mat& quantities) const;
+
+      void compute_difference(
+        const cv::Mat& frame,
+        PixelFormat format,
+        cv::Mat& motion_map
+      );
+
+      void compute_difference(
+        const cv::Mat& previous_frame,
+        const cv::Mat& frame,
+        PixelFormat format,
+        cv::Mat& motion_map
+      );
+
+      void compute_quantities(cv::Mat& motion_map, cv::Mat& quantities);
+
+      Repetition check_repetition(const cv::Mat& frame);
+
+      void count_inserted_frames(size_t count, size_t changes);
+
+      cv::Mat get_luma(const cv::Mat& frame, PixelFormat format) const;
+
+      static int get_opencv_type(PixelFormat format);
+
+      static PixelFormat get_pixel_format(const cv::Mat& frame);
+
+      static ColorSpace get_color_space(PixelFormat format);
   };
 } /* ns_labgen_p */
@@ -0,0 +1,64 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * MappedFile                                                             *
+     * ====================================================================== */
+
+    /**
+     * Read-only memory mapping of a whole file. The pages are shared with the
+     * page cache of the system, so that several processes mapping the same
+     * file do not duplicate it in memory.
+     */
+    class MappedFile {
+      protected:
+
+        std::string path;
+        const uint8_t* data;
+        size_t size;
+
+      public:
+
+        explicit MappedFile(const std::string& path);
+
+        MappedFile(const MappedFile&) = delete;
+
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        virtual ~MappedFile();
+
+        const uint8_t* get_data() const;
+
+        size_t get_size() const;
+
+        void advise_sequential() const;
+
+        void advise_will_need(size_t offset, size_t length) const;
+    };
+  } /* ns_internals */
+} /* ns_labgen_p */
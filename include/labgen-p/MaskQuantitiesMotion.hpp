@@ -0,0 +1,78 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "MotionMask.hpp"
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * MaskQuantitiesMotion                                                   *
+     * ====================================================================== */
+
+    /**
+     * Variant of QuantitiesMotion for a binary motion mask: the quantity of
+     * motion of a pixel is the number of pixels in motion in its window,
+     * clipped by the borders of the mask as well.
+     *
+     * The number of pixels in motion of each column of the window is kept
+     * while the window slides down, the rows entering and leaving it being
+     * unpacked word by word, except the empty words which are skipped. Each
+     * row of quantities is then a horizontal box sum of these counts. The
+     * popcounts of the rows give the number of pixels in motion of the whole
+     * window, so that the rows of a window without motion are just cleared.
+     */
+    class MaskQuantitiesMotion {
+      protected:
+
+        int size;
+        std::vector<int32_t> row_counts;
+        std::vector<int32_t> column_counts;
+        std::vector<int32_t> column_prefix;
+
+      public:
+
+        explicit MaskQuantitiesMotion(int size);
+
+        void compute(
+          const MotionMask& motion_mask,
+          cv::Mat& quantities_of_motion
+        );
+
+        int getOpenCVEncoding() const;
+
+      protected:
+
+        void accumulate_row(
+          const MotionMask& motion_mask,
+          int row,
+          int32_t sign
+        );
+
+        void sum_columns(int32_t* quantities_buffer);
+    };
+  } /* ns_internals */
+} /* ns_labgen_p */
@@ -0,0 +1,192 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "MappedFile.hpp"
+#include "PixelFormat.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * MotionCache                                                              *
+   * ======================================================================== */
+
+  /**
+   * File keeping the quantities of motion of every frame of a sequence, so
+   * that another run on the same sequence with another S can skip the frame
+   * difference and the filtering. They only depend on the frames, N, the
+   * motion scale, the motion threshold (negative without one), the detector
+   * and the pixel format, which form the key of the cache along with the
+   * size of the frames.
+   *
+   * The frames themselves are not stored, but referred to by their index and
+   * a hash of their content, which is checked as they are read again. The
+   * file starts with a header, followed by one record per frame, and ends with
+   * an index holding the offset of each record and the hash of each frame.
+   * The first frame has an empty record, as it has no quantities of motion.
+   *
+   * A record holds the quantities of motion in raster order, each one as the
+   * difference to the previous one, zigzag-encoded as a varint. As they are
+   * box-filtered, neighbouring quantities are close, and most of them take a
+   * single byte. The integers are stored in the byte order of the machine.
+   */
+  class MotionCache {
+    public:
+
+      struct Key {
+        int32_t height;
+        int32_t width;
+        int32_t n;
+        int32_t motion_scale;
+        int32_t motion_threshold;
+        int32_t detector;
+        PixelFormat format;
+      };
+
+    protected:
+
+      struct Header {
+        char magic[8];
+        uint32_t byte_order;
+        int32_t height;
+        int32_t width;
+        int32_t n;
+        int32_t motion_scale;
+        int32_t motion_threshold;
+        int32_t detector;
+        int32_t format;
+        int32_t rows;
+        int32_t cols;
+        uint64_t frames;
+        uint64_t index_offset;
+      };
+
+    protected:
+
+      static const char MAGIC[8];
+
+      static const uint32_t ENDIANNESS = 0x01020304;
+
+    protected:
+
+      static Header make_header(const Key& key);
+
+      static void encode(
+        const cv::Mat& quantities,
+        std::vector<uint8_t>& buffer
+      );
+
+      static bool decode(
+        const uint8_t* data,
+        size_t size,
+        cv::Mat& quantities
+      );
+  };
+
+  /* ======================================================================== *
+   * MotionCacheReader                                                        *
+   * ======================================================================== */
+
+  /**
+   * Memory-mapped cache, whose records can be read in any order. They are
+   * expected to be read sequentially, which the system is advised of.
+   */
+  class MotionCacheReader : public MotionCache {
+    protected:
+
+      std::string path;
+      std::unique_ptr<ns_internals::MappedFile> mapping;
+      Header header;
+
+    public:
+
+      MotionCacheReader(const MotionCacheReader&) = delete;
+
+      MotionCacheReader& operator=(const MotionCacheReader&) = delete;
+
+      size_t get_frames_count() const;
+
+      uint64_t get_frame_hash(size_t frame) const;
+
+      void read(size_t frame, cv::Mat& quantities) const;
+
+      static std::unique_ptr<MotionCacheReader> open(
+        const std::string& path,
+        const Key& key
+      );
+
+    protected:
+
+      explicit MotionCacheReader(const std::string& path);
+
+      uint64_t get_index_entry(size_t position) const;
+  };
+
+  /* ======================================================================== *
+   * MotionCacheWriter                                                        *
+   * ======================================================================== */
+
+  /**
+   * Writes a cache while a sequence is processed in order, the quantities of
+   * motion of the frames being appended as they are inserted. The cache is
+   * written aside, and only replaces the file of the given path once
+   * committed with the hashes of all the frames, so that an interrupted run
+   * leaves no partial cache.
+   */
+  class MotionCacheWriter : public MotionCache {
+    protected:
+
+      std::string path;
+      std::string temporary_path;
+      std::ofstream output;
+      Header header;
+      std::vector<uint64_t> offsets;
+      uint64_t position;
+      std::vector<uint8_t> buffer;
+      bool committed;
+
+    public:
+
+      MotionCacheWriter(const std::string& path, const Key& key);
+
+      MotionCacheWriter(const MotionCacheWriter&) = delete;
+
+      MotionCacheWriter& operator=(const MotionCacheWriter&) = delete;
+
+      virtual ~MotionCacheWriter();
+
+      void append(const cv::Mat& quantities);
+
+      void commit(const std::vector<uint64_t>& frame_hashes);
+
+    protected:
+
+      void check_output();
+  };
+} /* ns_labgen_p */
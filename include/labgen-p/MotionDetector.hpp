@@ -24,22 +24,33 @@
 
 namespace ns_labgen_p {
   namespace ns_internals {
-    /* =====================================================================  *
-     * FrameDifferenceC1L1                                                    *
+    /* ====================================================================== *
+     * MotionDetector                                                         *
      * ====================================================================== */
 
-    class FrameDifferenceC1L1 {
-      private:
-
-        cv::Mat previous_frame;
-
+    /**
+     * Computation of the motion map (CV_32SC1, from 0 to 255) of each frame
+     * with the previous one, or of any pair of frames, the current frame of
+     * the pair becoming the previous one of the next computation. The virtual
+     * calls are made once per frame, never per pixel.
+     */
+    class MotionDetector {
       public:
 
-        FrameDifferenceC1L1() {}
+        virtual ~MotionDetector() {}
+
+        virtual void compute(
+          const cv::Mat& current_frame,
+          cv::Mat& motion_map
+        ) = 0;
 
-        virtual ~FrameDifferenceC1L1() {}
+        virtual void compute(
+          const cv::Mat& last_frame,
+          const cv::Mat& current_frame,
+          cv::Mat& motion_map
+        ) = 0;
 
-        void compute(const cv::Mat& current_frame, cv::Mat& motion_map);
+        virtual void reset() = 0;
     };
   } /* ns_internals */
-} /* ns_labgpen_p */
+} /* ns_labgen_p */
@@ -0,0 +1,87 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * MotionMask                                                             *
+     * ====================================================================== */
+
+    /**
+     * Binary motion map packed with one bit per pixel, in 64-bit words. Bit b
+     * of word w of a row is the pixel w * 64 + b, and the unused bits of the
+     * last word of a row are always zero. The buffer is kept when the mask is
+     * created again with the same size.
+     */
+    class MotionMask {
+      public:
+
+        typedef uint64_t                                                  Word;
+
+      public:
+
+        static const int WORD_BITS = 64;
+
+      protected:
+
+        int rows;
+        int cols;
+        size_t words_per_row;
+        std::vector<Word> words;
+
+      public:
+
+        MotionMask();
+
+        void create(int rows, int cols);
+
+        bool empty() const;
+
+        int get_rows() const;
+
+        int get_cols() const;
+
+        size_t get_words_per_row() const;
+
+        Word* ptr(int row);
+
+        const Word* ptr(int row) const;
+
+        static int popcount(Word word) {
+#if defined(__GNUC__) || defined(__clang__)
+          return __builtin_popcountll(word);
+#else
+          word = word - ((word >> 1) & 0x5555555555555555ULL);
+          word = (word & 0x3333333333333333ULL) +
+                 ((word >> 2) & 0x3333333333333333ULL);
+          word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+          return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+        }
+    };
+  } /* ns_internals */
+} /* ns_labgen_p */
@@ -0,0 +1,49 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * PixelFormat                                                              *
+   * ======================================================================== */
+
+  /**
+   * Layouts of the frames given to LaBGen_P through a raw pointer and a row
+   * stride (in bytes).
+   *
+   * The 4:2:0 layouts are given as single-channel images of height * 3 / 2
+   * rows, as with cvtColor: the Y plane is followed by the U and V planes,
+   * whose rows are half the stride apart (I420), or by an interleaved UV plane
+   * with the same stride as the Y one (NV12).
+   */
+  enum PixelFormat {
+    BGR24,  /* Packed 8-bit B, G, R. */
+    BGRA32, /* Packed 8-bit B, G, R, and an ignored fourth channel. */
+    I420,   /* Planar 8-bit Y, U, V, with a 2x2 chroma subsampling. */
+    NV12,   /* Planar 8-bit Y, then interleaved U, V subsampled by 2x2. */
+    GRAY8,  /* Single 8-bit channel. */
+    GRAY16  /* Single 16-bit channel, in the native byte order. */
+  };
+
+  inline bool is_yuv420(PixelFormat format) {
+    return (format == PixelFormat::I420) || (format == PixelFormat::NV12);
+  }
+} /* ns_labgen_p */
@@ -36,18 +36,36 @@ namespace ns_labgen_p {
       protected:
 
         typedef int32_t                               QuantitiesMotionEncoding;
+        typedef int64_t                           WideQuantitiesMotionEncoding;
+
+      protected:
+
+        static const int32_t MAX_MOTION = 255;
 
       protected:
 
         int size;
+        SummedAreaTables<int32_t, QuantitiesMotionEncoding> sums;
+        SummedAreaTables<int32_t, WideQuantitiesMotionEncoding> wide_sums;
 
       public:
 
         QuantitiesMotion(int size);
 
-        void compute(cv::Mat& motion_map, cv::Mat& quantities_of_motion) const;
+        void compute(cv::Mat& motion_map, cv::Mat& quantities_of_motion);
 
         int getOpenCVEncoding() const;
+
+      protected:
+
+        bool requires_wide_sums(const cv::Mat& motion_map) const;
+
+        template <typename Sums>
+        void compute_window_sums(
+          const Sums& sums,
+          const cv::Mat& motion_map,
+          cv::Mat& quantities_of_motion
+        ) const;
     };
   } /* ns_internals */
 } /* ns_labgen_p */
@@ -0,0 +1,82 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+#include "FrameSource.hpp"
+#include "MappedFile.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * RawFrameSource                                                           *
+   * ======================================================================== */
+
+  /**
+   * Source reading raw BGR frames of a known size, stored one after the other
+   * in a file or streamed on the standard input ("-"). A file is mapped in
+   * memory, and the frames given by read() point directly into the mapping,
+   * so that they remain valid as long as the source is alive. The frames of
+   * a file can be sought.
+   */
+  class RawFrameSource : public FrameSource {
+    protected:
+
+      static const size_t READAHEAD_FRAMES = 8;
+
+    protected:
+
+      std::unique_ptr<ns_internals::MappedFile> mapping;
+      int32_t raw_height;
+      int32_t raw_width;
+      int reduction;
+      int32_t height;
+      int32_t width;
+      size_t frame_size;
+      size_t offset;
+
+    public:
+
+      RawFrameSource(
+        const std::string& input,
+        int32_t raw_height,
+        int32_t raw_width,
+        int reduction = 1
+      );
+
+      virtual bool read(cv::Mat& frame);
+
+      virtual int32_t get_height() const;
+
+      virtual int32_t get_width() const;
+
+      virtual bool is_seekable() const;
+
+      virtual size_t get_frames_count() const;
+
+      virtual void seek(size_t index);
+  };
+} /* ns_labgen_p */
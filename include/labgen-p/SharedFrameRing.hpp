@@ -0,0 +1,151 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+#include "PixelFormat.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * SharedFrameRing                                                          *
+   * ======================================================================== */
+
+  /**
+   * Ring buffer of raw frames living in a POSIX shared memory object, written
+   * by one producer process and read by any number of consumer processes,
+   * which attach to it read-only and never slow the producer down.
+   *
+   * The object starts with a Header of 64 bytes, followed by slot_count slots
+   * of slot_size bytes starting at data_offset. Each slot starts with a
+   * SlotHeader of 64 bytes, followed by the pixels of a frame, whose rows are
+   * frame_stride bytes apart, 4:2:0 frames being laid out as described in
+   * PixelFormat.hpp. All the integers are in the native byte order.
+   *
+   * Frame i (counted from 0) is written in slot i % slot_count. The sequence
+   * counter of the slot is set to 2i + 1 before writing it, and to 2i + 2
+   * once it is complete, so that a reader can tell whether a slot holds a
+   * given frame entirely. The published counter then becomes i + 1, and the
+   * notification word is incremented, which is a futex on Linux. The magic
+   * number is written last when the ring is created, and closed is set to 1
+   * once the producer has nothing more to publish.
+   */
+  class SharedFrameRing {
+    public:
+
+      /* "LBGP" in little endian. */
+      static const uint32_t MAGIC = 0x5047424c;
+      static const uint32_t VERSION = 1;
+      static const size_t ALIGNMENT = 64;
+
+      struct Header {
+        std::atomic<uint32_t> magic;
+        uint32_t version;
+        int32_t height;
+        int32_t width;
+        uint32_t format;             /* PixelFormat of the frames. */
+        uint32_t slot_count;
+        uint64_t frame_stride;       /* Bytes between two rows. */
+        uint64_t slot_size;          /* Bytes between two slots. */
+        uint64_t data_offset;        /* Offset of the first slot. */
+        std::atomic<uint64_t> published;
+        std::atomic<uint32_t> notification;
+        std::atomic<uint32_t> closed;
+      };
+
+      struct SlotHeader {
+        std::atomic<uint64_t> sequence;
+        uint8_t padding[ALIGNMENT - sizeof(std::atomic<uint64_t>)];
+      };
+
+    protected:
+
+      std::string name;
+      bool owner;
+      uint8_t* base;
+      size_t size;
+      Header* header;
+
+    public:
+
+      /* Attaches read-only to an existing ring. */
+      explicit SharedFrameRing(const std::string& name);
+
+      /* Creates a ring, which is removed when the producer destroys it. */
+      SharedFrameRing(
+        const std::string& name,
+        int32_t height,
+        int32_t width,
+        PixelFormat format,
+        uint32_t slot_count
+      );
+
+      SharedFrameRing(const SharedFrameRing&) = delete;
+
+      SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+
+      virtual ~SharedFrameRing();
+
+      /* Producer side. */
+      void publish(const cv::Mat& frame);
+
+      void close();
+
+      /* Consumer side. The frame given by view() points into the slot, thus
+       * it can be overwritten at any time: it must be copied, and the copy
+       * is only valid if holds() is still true afterwards.
+       */
+      bool view(uint64_t index, cv::Mat& frame) const;
+
+      bool holds(uint64_t index) const;
+
+      void wait(uint64_t published, int32_t timeout_ms) const;
+
+      uint64_t get_published() const;
+
+      bool is_closed() const;
+
+      int32_t get_height() const;
+
+      int32_t get_width() const;
+
+      PixelFormat get_format() const;
+
+      uint32_t get_slot_count() const;
+
+    protected:
+
+      SlotHeader* get_slot(uint64_t index) const;
+
+      int32_t get_rows() const;
+
+      int get_opencv_type() const;
+
+      static size_t get_pixel_size(PixelFormat format);
+
+      static size_t align(size_t size);
+  };
+} /* ns_labgen_p */
@@ -0,0 +1,87 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+#include "FrameSource.hpp"
+#include "SharedFrameRing.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * SharedMemorySource                                                       *
+   * ======================================================================== */
+
+  /**
+   * Source attached read-only to a SharedFrameRing fed by another process,
+   * designated by "shm:<name>". As the producer never waits for its
+   * readers, each frame is copied (or converted) out of its slot, and is
+   * dropped if the slot has been overwritten in the meantime. To make that
+   * unlikely, the source never lags more than half of the ring behind the
+   * producer: older frames are skipped.
+   *
+   * The 4:2:0 frames of a ring are converted to BGR, unless they are asked in
+   * their native layout and are not reduced.
+   */
+  class SharedMemorySource : public FrameSource {
+    protected:
+
+      static const int32_t WAIT_TIMEOUT_MS = 100;
+
+    protected:
+
+      SharedFrameRing ring;
+      int reduction;
+      bool convert_yuv;
+      int32_t height;
+      int32_t width;
+      uint64_t max_lag;
+      uint64_t next;
+      uint64_t skipped_frames;
+
+    public:
+
+      explicit SharedMemorySource(
+        const std::string& input,
+        int reduction = 1,
+        bool native_yuv = false
+      );
+
+      virtual bool read(cv::Mat& frame);
+
+      virtual int32_t get_height() const;
+
+      virtual int32_t get_width() const;
+
+      virtual PixelFormat get_pixel_format() const;
+
+      uint64_t get_skipped_frames() const;
+
+      static bool is_shared_memory(const std::string& input);
+
+    protected:
+
+      static std::string get_ring_name(const std::string& input);
+  };
+} /* ns_labgen_p */
@@ -0,0 +1,104 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "HistoryStorage.hpp"
+#include "PixelFormat.hpp"
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * SubsampledHistory                                                      *
+     * ====================================================================== */
+
+    /**
+     * Storage of the history of 4:2:0 frames at their own resolution: a luma
+     * sample is kept for every pixel, and a pair of chroma samples for every
+     * block of 2x2 pixels, whose key is the mean of the keys of its pixels.
+     *
+     * The keys and the samples are kept in flat arrays, without padding nor a
+     * vector per pixel. With S = 19, a pixel then costs 128.5 bytes instead of
+     * about 210 bytes with PatchesHistory. Only the changes of the luma
+     * histories are counted by the insertions.
+     */
+    class SubsampledHistory : public HistoryStorage {
+      protected:
+
+        size_t height;
+        size_t width;
+        size_t buffer_size;
+        int motion_scale;
+        std::vector<uint32_t> luma_sizes;
+        std::vector<uint32_t> luma_keys;
+        std::vector<uint8_t> luma_samples;
+        std::vector<uint32_t> chroma_sizes;
+        std::vector<uint32_t> chroma_keys;
+        std::vector<uint8_t> chroma_samples;
+
+      public:
+
+        SubsampledHistory(
+          size_t height,
+          size_t width,
+          size_t buffer_size,
+          int motion_scale = 1
+        );
+
+        virtual size_t insert(
+          const cv::Mat& quantities_of_motion,
+          const cv::Mat& current_frame,
+          PixelFormat format = PixelFormat::I420
+        );
+
+        virtual size_t insert_batch(
+          MatIterator quantities_of_motion,
+          MatIterator current_frames,
+          size_t batch_size,
+          PixelFormat format = PixelFormat::I420
+        );
+
+        virtual void median(cv::Mat& result, size_t size = ~0) const;
+
+        virtual bool empty() const;
+
+        virtual void clear();
+
+      protected:
+
+        bool insert_sample(
+          uint32_t* keys,
+          uint8_t* samples,
+          size_t channels,
+          uint32_t& history_size,
+          uint32_t key,
+          const uint8_t* sample
+        ) const;
+
+        static uint8_t median(uint8_t* values, size_t size);
+    };
+  } /* ns_internals */
+} /* ns_labgen_p */
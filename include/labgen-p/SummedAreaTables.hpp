@@ -23,6 +23,7 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 #include <opencv2/core/core.hpp>
 
@@ -35,21 +36,42 @@ namespace ns_labgen_p {
     /**
      * This class implements the method known as "Integral Image Representation"
      * or "Summed area tables" introduced by F. Crown at SIGGRAPH 1984.
+     *
+     * The table is padded with a zero row and a zero column, and its buffer is
+     * kept between two calls to rebuild(). It is built in two passes: the
+     * prefix sums of the rows are computed in parallel by blocks of rows, then
+     * the rows are accumulated in parallel by strips of columns. The Output
+     * type must be large enough to hold the sum of the whole image, e.g.
+     * int64_t instead of int32_t for large images.
      */
     template <typename Input, typename Output = Input>
     class SummedAreaTables {
+      private :
+
+        static const int BLOCK_ROWS = 64;
+        static const int STRIP_COLS = 512;
+
+      private :
+
+        class RowsPrefix;
+        class ColumnsAccumulation;
+
       private :
 
         int w;
         int h;
-        Output* sum;
+        std::vector<Output> sum;
 
       public :
 
+        SummedAreaTables();
+
         SummedAreaTables(const cv::Mat& mat);
 
         virtual ~SummedAreaTables();
 
+        void rebuild(const cv::Mat& mat);
+
         Output getIntegral(int row, int col) const;
 
         Output getIntegral(
@@ -58,6 +80,13 @@ namespace ns_labgen_p {
           int min_col,
           int max_col
         ) const;
+
+        Output getIntegralUnchecked(
+          int min_row,
+          int max_row,
+          int min_col,
+          int max_col
+        ) const;
     };
 
 #define _NS_LABGEN_P_NS_INTERNALS_SUMMED_AREA_TABLES_TPP_
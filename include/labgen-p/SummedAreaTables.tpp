@@ -22,39 +22,124 @@
 #ifndef _NS_LABGEN_P_NS_INTERNALS_SUMMED_AREA_TABLES_TPP_
 #error "SummedAreaTables.hpp must be included instead of SummedAreaTables.tpp"
 #else
+/* ========================================================================== *
+ * SummedAreaTables::RowsPrefix                                               *
+ * ========================================================================== */
+
+template <typename Input, typename Output>
+class SummedAreaTables<Input, Output>::RowsPrefix : public cv::ParallelLoopBody {
+  private :
+
+    const cv::Mat& mat;
+    Output* sum;
+    int w;
+    int h;
+
+  public :
+
+    RowsPrefix(const cv::Mat& mat, Output* sum, int w, int h) :
+    mat(mat), sum(sum), w(w), h(h) {}
+
+    void operator()(const cv::Range& range) const {
+      int min_row = range.start * BLOCK_ROWS;
+      int max_row = std::min(range.end * BLOCK_ROWS, h);
+
+      for (int row = min_row; row < max_row; ++row) {
+        const Input* buffer = mat.ptr<Input>(row);
+        Output* out = sum + (row + 1) * (w + 1);
+        Output acc = Output();
+
+        out[0] = Output();
+
+        for (int col = 0; col < w; ++col) {
+          acc += static_cast<Output>(buffer[col]);
+          out[col + 1] = acc;
+        }
+      }
+    }
+};
+
+/* ========================================================================== *
+ * SummedAreaTables::ColumnsAccumulation                                      *
+ * ========================================================================== */
+
+template <typename Input, typename Output>
+class SummedAreaTables<Input, Output>::ColumnsAccumulation :
+public cv::ParallelLoopBody {
+  private :
+
+    Output* sum;
+    int w;
+    int h;
+
+  public :
+
+    ColumnsAccumulation(Output* sum, int w, int h) : sum(sum), w(w), h(h) {}
+
+    void operator()(const cv::Range& range) const {
+      int min_col = range.start * STRIP_COLS + 1;
+      int max_col = std::min(range.end * STRIP_COLS, w) + 1;
+
+      /* Independent iterations over contiguous columns: vectorizable. */
+      for (int row = 2; row <= h; ++row) {
+        const Output* previous = sum + (row - 1) * (w + 1);
+        Output* current = sum + row * (w + 1);
+
+        for (int col = min_col; col < max_col; ++col)
+          current[col] += previous[col];
+      }
+    }
+};
+
 /* ========================================================================== *
  * SummedAreaTables                                                           *
  * ========================================================================== */
 
+template <typename Input, typename Output>
+SummedAreaTables<Input, Output>::SummedAreaTables() : w(0), h(0), sum() {}
+
+/******************************************************************************/
+
 template <typename Input, typename Output>
 SummedAreaTables<Input, Output>::SummedAreaTables(const cv::Mat& mat) :
-w(mat.cols),
-h(mat.rows),
-sum(new Output[mat.total()]) {
-  if (w == 0)
+w(0),
+h(0),
+sum() {
+  rebuild(mat);
+}
+
+/******************************************************************************/
+
+template <typename Input, typename Output>
+SummedAreaTables<Input, Output>::~SummedAreaTables() {}
+
+/******************************************************************************/
+
+template <typename Input, typename Output>
+void SummedAreaTables<Input, Output>::rebuild(const cv::Mat& mat) {
+  if (mat.cols == 0)
     throw std::logic_error("Image with zero width are not supported");
 
-  if (h == 0)
+  if (mat.rows == 0)
     throw std::logic_error("Image with zero height are not supported");
 
-  const Input* buffer = reinterpret_cast<const Input*>(mat.data);
+  if ((w != mat.cols) || (h != mat.rows)) {
+    w = mat.cols;
+    h = mat.rows;
 
-  for (int row = 0; row < h; ++row) {
-    for (int col = 0; col < w; ++col) {
-      sum[row * w + col] =
-        *(buffer++)                   +
-        getIntegral(row - 1, col    ) +
-        getIntegral(row    , col - 1) -
-        getIntegral(row - 1, col - 1) ;
-    }
+    /* The first row stays at zero, as well as the first column. */
+    sum.assign((h + 1) * (w + 1), Output());
   }
-}
 
-/******************************************************************************/
+  cv::parallel_for_(
+    cv::Range(0, (h + BLOCK_ROWS - 1) / BLOCK_ROWS),
+    RowsPrefix(mat, sum.data(), w, h)
+  );
 
-template <typename Input, typename Output>
-SummedAreaTables<Input, Output>::~SummedAreaTables() {
-  delete[] sum;
+  cv::parallel_for_(
+    cv::Range(0, (w + STRIP_COLS - 1) / STRIP_COLS),
+    ColumnsAccumulation(sum.data(), w, h)
+  );
 }
 
 /******************************************************************************/
@@ -70,7 +155,7 @@ inline Output SummedAreaTables<Input, Output>::getIntegral(
   if (col < 0)
     return Output();
 
-  return sum[std::min(row, h - 1) * w + std::min(col, w - 1)];
+  return sum[(std::min(row, h - 1) + 1) * (w + 1) + std::min(col, w - 1) + 1];
 }
 
 /******************************************************************************/
@@ -94,4 +179,26 @@ Output SummedAreaTables<Input, Output>::getIntegral(
     getIntegral(max_row    , min_col - 1) +
     getIntegral(min_row - 1, min_col - 1) ;
 }
+
+/******************************************************************************/
+
+template <typename Input, typename Output>
+inline Output SummedAreaTables<Input, Output>::getIntegralUnchecked(
+  int min_row,
+  int max_row,
+  int min_col,
+  int max_col
+) const {
+  /* Valid only for 0 <= min_row <= max_row < h and 0 <= min_col <= max_col < w.
+   * Thanks to the padding, no bound has to be tested.
+   */
+  const Output* top    = sum.data() + min_row * (w + 1);
+  const Output* bottom = sum.data() + (max_row + 1) * (w + 1);
+
+  return
+    bottom[max_col + 1] -
+    top   [max_col + 1] -
+    bottom[min_col    ] +
+    top   [min_col    ] ;
+}
 #endif /* _NS_LABGEN_P_NS_INTERNALS_SUMMED_AREA_TABLES_TPP_ */
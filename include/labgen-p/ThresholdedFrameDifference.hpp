@@ -0,0 +1,79 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "FrameDifference.hpp"
+#include "MotionMask.hpp"
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * ThresholdedFrameDifference                                             *
+     * ====================================================================== */
+
+    /**
+     * Frame difference giving a binary motion mask instead of a motion map:
+     * a pixel is in motion when its absolute difference is larger than the
+     * threshold. The frames are converted as by FrameDifferenceC1L1, and the
+     * mask takes 32 times less memory than a CV_32SC1 motion map.
+     *
+     * The differences of a row are compared in a branchless loop that the
+     * compiler vectorizes, then the flags are packed 8 by 8 with a
+     * multiplication.
+     */
+    class ThresholdedFrameDifference : public FrameDifferenceC1L1 {
+      protected:
+
+        uint8_t threshold;
+        std::vector<uint8_t> flags;
+
+      public:
+
+        explicit ThresholdedFrameDifference(
+          int scale = 1,
+          uint8_t threshold = 0
+        );
+
+        using FrameDifferenceC1L1::compute;
+
+        void compute(const cv::Mat& current_frame, MotionMask& motion_mask);
+
+        void compute(
+          const cv::Mat& last_frame,
+          const cv::Mat& current_frame,
+          MotionMask& motion_mask
+        );
+
+        void set_threshold(uint8_t threshold);
+
+        uint8_t get_threshold() const;
+
+      protected:
+
+        static MotionMask::Word pack(const uint8_t* flags_buffer);
+    };
+  } /* ns_internals */
+} /* ns_labgen_p */
@@ -0,0 +1,81 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * TripleBuffer                                                           *
+     * ====================================================================== */
+
+    /**
+     * Lock-free exchange of the latest value between one producer thread and
+     * one consumer thread. The producer fills the back buffer and publishes it,
+     * while the consumer reads the front buffer and updates it with the last
+     * published one. Neither of them is ever blocked: a value published while
+     * the previous one has not been consumed yet replaces it.
+     *
+     * The third buffer lies between the two others, and its index is swapped
+     * atomically with the back or front one, along with a flag telling whether
+     * it holds a value that has not been consumed.
+     */
+    template <typename T>
+    class TripleBuffer {
+      protected:
+
+        static const uint8_t INDEX_MASK = 0x3;
+        static const uint8_t FRESH      = 0x4;
+
+      protected:
+
+        T buffers[3];
+        uint8_t back;
+        uint8_t front;
+        std::atomic<uint8_t> middle;
+
+      public:
+
+        TripleBuffer();
+
+        TripleBuffer(const TripleBuffer&) = delete;
+
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        T& get_back();
+
+        void publish();
+
+        bool is_pending() const;
+
+        bool update();
+
+        T& get_front();
+    };
+
+#define _NS_LABGEN_P_NS_INTERNALS_TRIPLE_BUFFER_TPP_
+#include "TripleBuffer.tpp"
+#undef  _NS_LABGEN_P_NS_INTERNALS_TRIPLE_BUFFER_TPP_
+  } /* ns_internals */
+} /* ns_labgen_p */
@@ -0,0 +1,76 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _NS_LABGEN_P_NS_INTERNALS_TRIPLE_BUFFER_TPP_
+#error "TripleBuffer.hpp must be included instead of TripleBuffer.tpp"
+#else
+/* ========================================================================== *
+ * TripleBuffer                                                               *
+ * ========================================================================== */
+
+template <typename T>
+TripleBuffer<T>::TripleBuffer() :
+back(0),
+front(2),
+middle(1) {}
+
+/******************************************************************************/
+
+template <typename T>
+T& TripleBuffer<T>::get_back() {
+  return buffers[back];
+}
+
+/******************************************************************************/
+
+template <typename T>
+void TripleBuffer<T>::publish() {
+  uint8_t previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+  back = previous & INDEX_MASK;
+}
+
+/******************************************************************************/
+
+template <typename T>
+bool TripleBuffer<T>::is_pending() const {
+  return middle.load(std::memory_order_acquire) & FRESH;
+}
+
+/******************************************************************************/
+
+template <typename T>
+bool TripleBuffer<T>::update() {
+  if (!is_pending())
+    return false;
+
+  /* The producer can only publish a fresher value in the meantime. */
+  uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+  front = previous & INDEX_MASK;
+
+  return true;
+}
+
+/******************************************************************************/
+
+template <typename T>
+T& TripleBuffer<T>::get_front() {
+  return buffers[front];
+}
+#endif /* _NS_LABGEN_P_NS_INTERNALS_TRIPLE_BUFFER_TPP_ */
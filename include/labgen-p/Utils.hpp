@@ -21,6 +21,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -44,6 +45,8 @@ namespace ns_labgen_p {
 
       static ROIs getROIs(size_t height, size_t width);
 
+      static int scaled_size(int size, int scale);
+
       static void normalize_mat(cv::Mat& input, double max = 1);
 
       static void normalize_mat(
@@ -51,5 +54,13 @@ namespace ns_labgen_p {
         cv::Mat& output,
         double max = 1
       );
+
+      static void yuv_to_bgr(const cv::Mat& yuv, cv::Mat& bgr);
+
+      static void bgr_to_yuv(const cv::Mat& bgr, cv::Mat& yuv);
+
+      static void reduce_depth(const cv::Mat& input, cv::Mat& output);
+
+      static uint64_t hash(const cv::Mat& frame);
   };
 } /* ns_labgen_p */
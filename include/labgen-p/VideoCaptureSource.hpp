@@ -0,0 +1,62 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "FrameSource.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * VideoCaptureSource                                                       *
+   * ======================================================================== */
+
+  class VideoCaptureSource : public FrameSource {
+    protected:
+
+      cv::VideoCapture decoder;
+      int reduction;
+      int32_t height;
+      int32_t width;
+      size_t frames_count;
+      cv::Mat decoded;
+
+    public:
+
+      explicit VideoCaptureSource(const std::string& input, int reduction = 1);
+
+      virtual ~VideoCaptureSource();
+
+      virtual bool read(cv::Mat& frame);
+
+      virtual int32_t get_height() const;
+
+      virtual int32_t get_width() const;
+
+      virtual size_t get_frames_count() const;
+  };
+} /* ns_labgen_p */
@@ -0,0 +1,147 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "ArgumentsHandler.hpp"
+#include "GridWindow.hpp"
+#include "LaBGen_P.hpp"
+#include "PixelFormat.hpp"
+#include "TripleBuffer.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * Visualizer                                                               *
+   * ======================================================================== */
+
+  /**
+   * Renders the visualization and records it on a dedicated thread, so that
+   * the processing loop never waits for the windows, the encoder or waitKey.
+   * The processing thread fills a snapshot of its state and publishes it,
+   * while the rendering thread always renders the last published one. The
+   * snapshots published in the meantime are dropped, thus taking one is only
+   * worth it when is_ready() returns true. The background of a snapshot is
+   * the last one published by LaBGen_P, thus taking a snapshot never waits
+   * for the history.
+   *
+   * On screen and without a recording, the rendering thread pauses between
+   * two renderings for three times the duration of the last one, as a
+   * display does not need every frame and the rendering would otherwise
+   * compete with the processing on the same cores.
+   *
+   * All the HighGUI calls, including the creation of the windows, are made by
+   * the rendering thread.
+   */
+  class Visualizer {
+    public:
+
+      /* The revision identifies the frame of a snapshot, usually its index,
+       * so that a snapshot with the same frame and background is not rendered
+       * twice. The background is empty until a first publication.
+       */
+      struct Snapshot {
+        uint64_t revision;
+        cv::Mat input;
+        PixelFormat format;
+        LaBGen_P::BackgroundSnapshotPtr background;
+        cv::Mat motion_map;
+        cv::Mat quantities_of_motion;
+      };
+
+    protected:
+
+      typedef ns_internals::TripleBuffer<Snapshot>                  Snapshots;
+
+    protected:
+
+      int32_t height;
+      int32_t width;
+      bool visualization;
+      bool split_vis;
+      bool record;
+      std::string record_path;
+      int32_t record_fps;
+      int32_t v_height;
+      int32_t v_width;
+      bool keep_ratio;
+      int32_t wait;
+      Snapshots snapshots;
+      size_t rendered_frames;
+      uint64_t last_revision;
+      uint64_t last_epoch;
+      uint64_t reduced_epoch;
+      bool closed;
+      bool wait_for_key;
+      std::mutex rendering_mutex;
+      std::condition_variable published;
+      std::exception_ptr failure;
+      std::unique_ptr<GridWindow> window;
+      std::unique_ptr<cv::VideoWriter> record_stream;
+      cv::Mat input_8u;
+      cv::Mat background_8u;
+      cv::Mat motion_map_8u;
+      cv::Mat normalized_qom;
+      std::thread rendering_thread;
+
+    public:
+
+      Visualizer(int32_t height, int32_t width, const ArgumentsHandler& args_h);
+
+      Visualizer(const Visualizer&) = delete;
+
+      Visualizer& operator=(const Visualizer&) = delete;
+
+      virtual ~Visualizer();
+
+      bool is_ready() const;
+
+      Snapshot& get_snapshot();
+
+      void publish();
+
+      void finish(bool wait_for_key = false);
+
+      size_t get_rendered_frames() const;
+
+    protected:
+
+      void rendering_loop();
+
+      void open();
+
+      void render(const Snapshot& snapshot);
+
+      static uint64_t get_epoch(const Snapshot& snapshot);
+
+      void close();
+  };
+} /* ns_labgen_p */
@@ -0,0 +1,96 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ns_labgen_p {
+  namespace ns_internals {
+    /* ====================================================================== *
+     * WorkStealingPool                                                       *
+     * ====================================================================== */
+
+    /**
+     * Pool of threads, each one owning a queue of tasks. The submitted tasks
+     * are spread over the queues, and a thread whose queue is empty steals the
+     * oldest task of another one, so that all the threads stay busy while
+     * tasks of very different lengths remain. The first exception thrown by a
+     * task is reported by the next call to wait().
+     */
+    class WorkStealingPool {
+      public:
+
+        typedef std::function<void()>                                     Task;
+
+      protected:
+
+        struct Worker {
+          std::deque<Task> tasks;
+          std::mutex mutex;
+        };
+
+        typedef std::unique_ptr<Worker>                              WorkerPtr;
+
+      protected:
+
+        std::vector<WorkerPtr> workers;
+        std::vector<std::thread> threads;
+        size_t next_worker;
+        size_t queued;
+        size_t pending;
+        bool stopping;
+        std::exception_ptr failure;
+        std::mutex mutex;
+        std::condition_variable work_available;
+        std::condition_variable all_done;
+
+      public:
+
+        explicit WorkStealingPool(size_t threads_count = 0);
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        virtual ~WorkStealingPool();
+
+        void submit(Task task);
+
+        void wait();
+
+        size_t size() const;
+
+      protected:
+
+        void run(size_t index);
+
+        bool pop(size_t index, Task& task);
+    };
+  } /* ns_internals */
+} /* ns_labgen_p */
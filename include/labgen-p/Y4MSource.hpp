@@ -0,0 +1,112 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "FrameSource.hpp"
+#include "MappedFile.hpp"
+
+namespace ns_labgen_p {
+  /* ======================================================================== *
+   * Y4MSource                                                                *
+   * ======================================================================== */
+
+  /**
+   * Source reading a YUV4MPEG2 stream from a file, which is mapped in memory,
+   * or from the standard input ("-"). The 4:2:0, 4:4:4 and mono color spaces
+   * are supported, and are converted to BGR straight from the mapping. When
+   * asked to, 4:2:0 and mono frames at their full size are delivered as is in
+   * the I420 and GRAY8 layouts, pointing into the mapping.
+   *
+   * The frames of a file can be sought, the offsets of the frames being
+   * indexed at the first need, as their headers may differ in size.
+   */
+  class Y4MSource : public FrameSource {
+    protected:
+
+      enum Chroma {
+        CHROMA_420,
+        CHROMA_444,
+        CHROMA_MONO
+      };
+
+    protected:
+
+      static const size_t READAHEAD_FRAMES = 8;
+
+    protected:
+
+      std::unique_ptr<ns_internals::MappedFile> mapping;
+      int32_t raw_height;
+      int32_t raw_width;
+      Chroma chroma;
+      int reduction;
+      bool native;
+      int32_t height;
+      int32_t width;
+      size_t frame_size;
+      size_t offset;
+      size_t frames_offset;
+      mutable std::vector<size_t> frame_offsets;
+      std::vector<uint8_t> buffer;
+
+    public:
+
+      explicit Y4MSource(
+        const std::string& input,
+        int reduction = 1,
+        bool native_yuv = false
+      );
+
+      virtual bool read(cv::Mat& frame);
+
+      virtual int32_t get_height() const;
+
+      virtual int32_t get_width() const;
+
+      virtual PixelFormat get_pixel_format() const;
+
+      virtual bool is_seekable() const;
+
+      virtual size_t get_frames_count() const;
+
+      virtual void seek(size_t index);
+
+      static bool is_y4m(const std::string& input);
+
+    protected:
+
+      bool read_line(std::string& line);
+
+      void parse_header(const std::string& header);
+
+      void convert(const uint8_t* data, cv::Mat& frame) const;
+
+      void index_frames() const;
+  };
+} /* ns_labgen_p */
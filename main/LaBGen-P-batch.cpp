@@ -0,0 +1,107 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <labgen-p/BatchRunner.hpp>
+
+using namespace cv;
+using namespace std;
+using namespace boost::program_options;
+using namespace ns_labgen_p;
+
+/******************************************************************************
+ * Main program                                                               *
+ ******************************************************************************/
+
+/*
+ * Batch mode: processes all the sequences of a manifest in a single process,
+ * on a pool of threads that reuses the histories from a sequence to another.
+ */
+int main(int argc, char** argv) {
+  options_description opt_desc(
+    "LaBGen-P - Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017\n"
+    "http://www.montefiore.ulg.ac.be/~blaugraud\n"
+    "http://www.telecom.ulg.ac.be/labgen\n\n"
+    "Usage: ./LaBGen-P-batch [options]\n\n"
+    "Each line of the manifest is a job: "
+    "<input> <output> <S> <N> [<motion scale>]"
+  );
+
+  opt_desc.add_options()
+    (
+      "help",
+      "print this help message"
+    )
+    (
+      "manifest,m",
+      value<string>(),
+      "path to the manifest listing the jobs"
+    )
+    (
+      "threads,j",
+      value<uint32_t>()->default_value(0),
+      "number of threads (0 for the number of cores)"
+    )
+  ;
+
+  variables_map vars_map;
+  store(parse_command_line(argc, argv, opt_desc), vars_map);
+  notify(vars_map);
+
+  if (vars_map.count("help") || !vars_map.count("manifest")) {
+    cout << opt_desc << endl;
+    return vars_map.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  BatchRunner runner(vars_map["threads"].as<uint32_t>());
+  runner.load_manifest(vars_map["manifest"].as<string>());
+
+  /* The sequences are processed in parallel, thus each one is processed
+   * sequentially rather than competing for the cores with the others.
+   */
+  if (runner.get_threads_count() > 1)
+    setNumThreads(0);
+
+  cout << "Processing " << vars_map["manifest"].as<string>() << " with "
+       << runner.get_threads_count() << " threads..." << endl;
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  size_t failures = runner.run(cout);
+
+  cout << "Done in "
+       << chrono::duration<double>(chrono::steady_clock::now() - start).count()
+       << " s";
+
+  if (failures > 0)
+    cout << ", " << failures << " jobs failed";
+
+  cout << "." << endl;
+
+  return (failures > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
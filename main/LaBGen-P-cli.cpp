@@ -22,6 +22,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <ostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -31,15 +32,26 @@
 #include <opencv2/highgui/highgui.hpp>
 
 #include <labgen-p/ArgumentsHandler.hpp>
-#include <labgen-p/LaBGen_P.hpp>
-#include <labgen-p/GridWindow.hpp>
-#include <labgen-p/TextProperties.hpp>
+#include <labgen-p/AsyncLaBGen_P.hpp>
+#include <labgen-p/BackgroundWriter.hpp>
+#include <labgen-p/FrameSource.hpp>
+#include <labgen-p/MotionCache.hpp>
+#include <labgen-p/SharedMemorySource.hpp>
 #include <labgen-p/Utils.hpp>
+#include <labgen-p/Visualizer.hpp>
 
 using namespace cv;
 using namespace std;
 using namespace ns_labgen_p;
 
+/* Stride of the first coarse-to-fine pass, halved by each next pass. */
+static const size_t COARSE_STRIDE = 64;
+
+/* Inserted frames between two backgrounds of the visualization, unless the
+ * backgrounds are written more often.
+ */
+static const size_t PREVIEW_PERIOD = 10;
+
 /******************************************************************************
  * Main program                                                               *
  ******************************************************************************/
@@ -60,6 +72,14 @@ int main(int argc, char** argv) {
     return EXIT_SUCCESS;
   }
 
+  args_h.parse_vars_map();
+
+  /* The standard output is left to the stream of backgrounds, if any. */
+  ostream background_stream(cout.rdbuf());
+
+  if (!args_h.get_output_stream().empty())
+    cout.rdbuf(cerr.rdbuf());
+
   /*
    * Welcome message.
    */
@@ -73,186 +93,423 @@ int main(int argc, char** argv) {
   cout << "===========================================================" << endl;
   cout << endl;
 
-  args_h.parse_vars_map();
   args_h.print_parameters();
 
   /****************************************************************************
    * Reading sequence.                                                        *
    ****************************************************************************/
 
-  VideoCapture decoder(args_h.get_input());
-
-  if (!decoder.isOpened()) {
-    throw runtime_error(
-      "Cannot open the '" + args_h.get_input() + "' sequence."
-    );
-  }
+  FrameSource::FrameSourcePtr source = FrameSource::open(
+    args_h.get_input(),
+    args_h.get_reduction(),
+    Size(args_h.get_raw_width(), args_h.get_raw_height()),
+    args_h.get_native_yuv()
+  );
 
-  int32_t height = decoder.get(CV_CAP_PROP_FRAME_HEIGHT);
-  int32_t width  = decoder.get(CV_CAP_PROP_FRAME_WIDTH);
+  int32_t height = source->get_height();
+  int32_t width  = source->get_width();
 
   cout << "Reading sequence " << args_h.get_input() << "..." << endl;
 
   cout << "           height: " << height     << endl;
   cout << "            width: " << width      << endl;
+  cout << endl;
 
-  typedef vector<Mat>                                                FramesVec;
-  vector<Mat> frames;
-  frames.reserve(decoder.get(CV_CAP_PROP_FRAME_COUNT));
-
-  Mat frame;
+  /****************************************************************************
+   * Initialization of graphical components and video streams.                *
+   ****************************************************************************/
 
-  while (decoder.read(frame))
-    frames.push_back(frame.clone());
+  /* Rendering and recording happen on a dedicated thread. */
+  unique_ptr<Visualizer> visualizer;
 
-  decoder.release();
-  cout << frames.size() << " frames read." << endl << endl;
+  if (args_h.get_visualization() || args_h.get_record()) {
+    visualizer = unique_ptr<Visualizer>(
+      new Visualizer(height, width, args_h)
+    );
+  }
 
   /****************************************************************************
-   * Initialization of graphical components and video streams.                *
+   * Processing.                                                              *
    ****************************************************************************/
 
-  unique_ptr<Mat> motion_map_8u;
-  unique_ptr<Mat> normalized_qom;
+  cout << "Start processing..." << endl;
 
-  unique_ptr<GridWindow> window;
-  unique_ptr<VideoWriter> record_stream;
+  /* Background matrix, allocated by LaBGen-P with the type of the frames. */
+  Mat background;
 
-  if (args_h.get_visualization() || args_h.get_record()) {
-    motion_map_8u  = unique_ptr<Mat>(new Mat(height, width, CV_8UC1));
-    normalized_qom = unique_ptr<Mat>(new Mat(height, width, CV_8UC1));
+  /* Initialization of the LaBGen-P algorithm. */
+  AsyncLaBGen_P labgen_p(
+    height,
+    width,
+    args_h.get_s_param(),
+    args_h.get_n_param(),
+    args_h.get_motion_scale()
+  );
 
-    if (!args_h.get_split_vis()) {
-      TextProperties::TextPropertiesPtr title_properties = nullptr;
+  if (args_h.get_subsample_chroma())
+    labgen_p.subsample_chroma();
 
-      if (args_h.get_record()) {
-        title_properties = make_shared<TextProperties>(
-          TextProperties::Font::FONT_DUPLEX,
-          0.8
-        );
-      }
-      else
-        title_properties = make_shared<TextProperties>();
-
-      window = unique_ptr<GridWindow>(
-        new GridWindow(
-          "LaBGen-P",
-          (args_h.get_v_height() > 0) ? args_h.get_v_height() : height,
-          (args_h.get_v_width() > 0) ? args_h.get_v_width() : width,
-          2,
-          2,
-          title_properties
-        )
-      );
+  if (args_h.get_approximate_median())
+    labgen_p.approximate_median();
 
-      if (args_h.get_keep_ratio())
-        window->keep_ratio();
+  if (args_h.get_motion_threshold() >= 0)
+    labgen_p.threshold_motion(args_h.get_motion_threshold());
 
-      if (args_h.get_record()) {
-        const Mat& buffer = window->get_buffer();
+  LaBGen_P::Detector detector = LaBGen_P::DETECTOR_C1L1;
 
-        record_stream = unique_ptr<VideoWriter>(
-          new VideoWriter(
-            args_h.get_record_path(),
-            CV_FOURCC('M','J','P','G'),
-            args_h.get_record_fps(),
-            Size(buffer.cols, buffer.rows)
-          )
-        );
-      }
-    }
+  if (args_h.get_detector() == "c3l1")
+    detector = LaBGen_P::DETECTOR_C3L1;
+  else if (args_h.get_detector() == "c3l2")
+    detector = LaBGen_P::DETECTOR_C3L2;
+
+  labgen_p.use_detector(detector);
+
+  if (args_h.get_duplicate_tolerance() >= 0)
+    labgen_p.skip_duplicates(args_h.get_duplicate_tolerance());
+
+  if (args_h.get_stability_window() > 0) {
+    labgen_p.monitor_convergence(
+      args_h.get_stability_window(),
+      args_h.get_max_changes(),
+      args_h.get_max_motion()
+    );
   }
 
-  /****************************************************************************
-   * Processing.                                                              *
-   ****************************************************************************/
+  /* Path of the background, also written after each coarse-to-fine pass. */
+  stringstream output_prefix;
+  output_prefix << args_h.get_output() << "/output_"
+                << args_h.get_s_param() << "_"
+                << args_h.get_n_param();
 
-  cout << "Start processing..." << endl;
+  stringstream output_file;
+  output_file << output_prefix.str() << ".png";
 
-  /* Initialization of the background matrix. */
-  Mat background = Mat(height, width, CV_8UC3);
+  /* Backgrounds published every K inserted frames by the history stage, and
+   * written by a dedicated thread.
+   */
+  unique_ptr<BackgroundWriter> writer;
 
-  /* Initialization of the LaBGen-P algorithm. */
-  LaBGen_P labgen_p(height, width, args_h.get_s_param(), args_h.get_n_param());
+  if (args_h.get_output_every() > 0) {
+    if (args_h.get_output_stream().empty()) {
+      writer = unique_ptr<BackgroundWriter>(
+        new BackgroundWriter(output_prefix.str())
+      );
+    }
+    else {
+      writer = unique_ptr<BackgroundWriter>(
+        new BackgroundWriter(
+          (args_h.get_output_stream() == "y4m") ?
+            BackgroundWriter::FORMAT_Y4M : BackgroundWriter::FORMAT_RAW,
+          background_stream
+        )
+      );
+    }
 
-  /* Processing loop. */
-  cout << endl << "Processing..." << endl;
-  bool first_frame = true;
+    BackgroundWriter* background_writer = writer.get();
 
-  for (auto it = frames.begin(), end = frames.end(); it != end; ++it) {
-    labgen_p.insert(*it);
+    labgen_p.set_publication_callback(
+      [background_writer](
+        const AsyncLaBGen_P::BackgroundSnapshotPtr& snapshot
+      ) {
+        background_writer->write(snapshot);
+      }
+    );
+
+    labgen_p.set_publication_period(args_h.get_output_every());
+  }
+  else if (visualizer != nullptr)
+    labgen_p.set_publication_period(PREVIEW_PERIOD);
+
+  /* The pairs of frames can only be processed out of order with a random
+   * access to the frames.
+   */
+  bool coarse_to_fine = args_h.get_coarse_to_fine();
 
-    /* Skipping first frame. */
-    if (first_frame) {
-      cout << "Skipping first frame..." << endl;
+  if (coarse_to_fine && !source->is_seekable()) {
+    cerr << "/!\\ The input has no random access, its frames will be ";
+    cerr << "processed in order!" << endl << endl;
 
-      ++it;
-      first_frame = false;
+    coarse_to_fine = false;
+  }
 
-      continue;
+  /* Quantities of motion read from the cache of a previous run, or written to
+   * it for the next runs.
+   */
+  unique_ptr<MotionCacheReader> motion_cache;
+  unique_ptr<MotionCacheWriter> cache_writer;
+  vector<uint64_t> frame_hashes;
+
+  if (!args_h.get_motion_cache().empty()) {
+    MotionCache::Key key = {
+      height,
+      width,
+      args_h.get_n_param(),
+      args_h.get_motion_scale(),
+      args_h.get_motion_threshold(),
+      detector,
+      source->get_pixel_format()
+    };
+
+    motion_cache = MotionCacheReader::open(args_h.get_motion_cache(), key);
+
+    if (motion_cache != nullptr) {
+      cout << "Reading the quantities of motion from "
+           << args_h.get_motion_cache() << "..." << endl;
+    }
+    else if (coarse_to_fine) {
+      cerr << "/!\\ The motion cache can only be written by processing the ";
+      cerr << "frames in order, it will be ignored!" << endl << endl;
     }
+    else {
+      cache_writer = unique_ptr<MotionCacheWriter>(
+        new MotionCacheWriter(args_h.get_motion_cache(), key)
+      );
+
+      MotionCacheWriter* motion_writer = cache_writer.get();
 
-    /* Visualization. */
-    if (args_h.get_visualization() || args_h.get_record()) {
-      labgen_p.generate_background(background);
-      labgen_p.get_motion_map().convertTo(*motion_map_8u, CV_8U);
+      labgen_p.set_motion_callback(
+        [motion_writer](const Mat& quantities) {
+          motion_writer->append(quantities);
+        }
+      );
+    }
+  }
 
-      Utils::normalize_mat(
-        labgen_p.get_quantities_of_motion(),
-        *normalized_qom,
-        255.
+  /* A frame read again must be the one the cache was written with. */
+  auto check_cached_frame = [&](const Mat& frame, size_t index) {
+    if (
+      (index >= motion_cache->get_frames_count()) ||
+      (Utils::hash(frame) != motion_cache->get_frame_hash(index))
+    ) {
+      throw runtime_error(
+        "The input does not match the motion cache '" +
+        args_h.get_motion_cache() + "'."
       );
+    }
+  };
+
+  /* Processing loop. */
+  cout << endl << "Processing..." << endl;
+  bool first_frame = true;
+  size_t frames_count = 0;
+  Mat last_frame;
 
-      if (args_h.get_split_vis()) {
-        imshow("Input video", *it);
-        imshow("LaBGen-P", background);
-        imshow("Motion map", *motion_map_8u);
-        imshow("Quantities of motion", *normalized_qom);
+  /* Snapshot of the current state, rendered asynchronously. Neither the
+   * background, which is the last published one, nor the motion wait for the
+   * frames in flight. Each frame being read into a new buffer, the snapshot
+   * shares it rather than copying it on the processing thread.
+   */
+  auto publish_snapshot = [&](
+    const Mat& frame,
+    const AsyncLaBGen_P::BackgroundSnapshotPtr& background
+  ) {
+    Visualizer::Snapshot& snapshot = visualizer->get_snapshot();
+
+    snapshot.revision = frames_count;
+    snapshot.input = frame;
+    snapshot.format = source->get_pixel_format();
+    snapshot.background = background;
+    labgen_p.copy_motion(snapshot.motion_map, snapshot.quantities_of_motion);
+
+    visualizer->publish();
+  };
+
+  if (coarse_to_fine) {
+    /* Pair k is made of the frames k - 1 and k. Each pass takes the pairs of
+     * its stride that were not taken by the previous ones.
+     */
+    size_t frames = source->get_frames_count();
+    bool stable = false;
+
+    for (size_t stride = COARSE_STRIDE; (stride >= 1) && !stable; stride /= 2) {
+      for (size_t pair = stride; pair < frames; pair += stride) {
+        if ((stride != COARSE_STRIDE) && (pair % (2 * stride) == 0))
+          continue;
+
+        /* New buffers for each pair, as the pipeline keeps references. */
+        Mat previous_frame;
+        Mat frame;
+
+        source->seek(pair - 1);
+
+        if (!source->read(previous_frame) || !source->read(frame))
+          break;
+
+        ++frames_count;
+        last_frame = frame;
+
+        if (motion_cache != nullptr) {
+          check_cached_frame(previous_frame, pair - 1);
+          check_cached_frame(frame, pair);
+
+          Mat quantities;
+          motion_cache->read(pair, quantities);
+
+          labgen_p.submit_precomputed(
+            quantities,
+            frame,
+            source->get_pixel_format()
+          );
+        }
+        else {
+          labgen_p.submit_pair(
+            previous_frame,
+            frame,
+            source->get_pixel_format()
+          );
+        }
+
+        if ((visualizer != nullptr) && visualizer->is_ready())
+          publish_snapshot(frame, labgen_p.get_background_snapshot());
+
+        if (labgen_p.has_converged()) {
+          cout << "The background is stable, stopping..." << endl;
+          stable = true;
+
+          break;
+        }
       }
-      else {
-        window->display(*it, 0);
-        window->put_title("Input video", 0);
 
-        window->display(background, 1);
-        window->put_title("Background estimated by LaBGen-P", 1);
+      /* The background so far, refined by the next passes. */
+      if ((stride > 1) && !stable && (frames_count > 0)) {
+        labgen_p.update_background(background);
+        imwrite(output_file.str(), background);
 
-        window->display(*motion_map_8u, 2);
-        window->put_title("Motion map", 2);
+        cout << "Pass of stride " << stride << " done after " << frames_count
+             << " pairs, " << output_file.str() << " written." << endl;
+      }
+    }
+  }
+  else {
+    for (;;) {
+      /* A new buffer for each frame, as the pipeline keeps a reference to
+       * it.
+       */
+      Mat frame;
+
+      if (!source->read(frame))
+        break;
+
+      ++frames_count;
+      last_frame = frame;
+
+      /* The first frame only has a hash in the cache. */
+      if (motion_cache != nullptr) {
+        check_cached_frame(frame, frames_count - 1);
+
+        if (frames_count > 1) {
+          Mat quantities;
+          motion_cache->read(frames_count - 1, quantities);
+
+          labgen_p.submit_precomputed(
+            quantities,
+            frame,
+            source->get_pixel_format()
+          );
+        }
+      }
+      else {
+        if (cache_writer != nullptr)
+          frame_hashes.push_back(Utils::hash(frame));
 
-        window->display(*normalized_qom, 3);
-        window->put_title("Quantities of motion", 3);
+        labgen_p.submit(frame, source->get_pixel_format());
+      }
 
-        if (args_h.get_visualization())
-          window->refresh();
+      /* Skipping first frame. */
+      if (first_frame) {
+        cout << "Skipping first frame..." << endl;
+        first_frame = false;
 
-        if (args_h.get_record())
-          *record_stream << window->get_buffer();
+        continue;
       }
 
-      if (args_h.get_visualization())
-        waitKey(args_h.get_wait());
+      /* Visualization. A snapshot is only taken once the previous one has
+       * been rendered, so that the processing never waits for the rendering.
+       */
+      if ((visualizer != nullptr) && visualizer->is_ready())
+        publish_snapshot(frame, labgen_p.get_background_snapshot());
+
+      if (labgen_p.has_converged()) {
+        cout << "The background is stable, stopping..." << endl;
+        break;
+      }
     }
   }
 
+  cout << frames_count << (coarse_to_fine ? " pairs" : " frames")
+       << " processed." << endl;
+
+  /* A shared frame ring drops the frames that could not be read in time. */
+  const SharedMemorySource* shared_source =
+    dynamic_cast<const SharedMemorySource*>(source.get());
+
+  if ((shared_source != nullptr) && shared_source->get_skipped_frames()) {
+    cerr << "/!\\ " << shared_source->get_skipped_frames()
+         << " frames have been skipped to keep up with the producer!" << endl;
+  }
+
+  cout << endl;
+
   /* Compute background and write it. */
-  stringstream output_file;
-  output_file << args_h.get_output() << "/output_"
-              << args_h.get_s_param() << "_"
-              << args_h.get_n_param() << ".png";
+  labgen_p.update_background(background);
 
-  labgen_p.generate_background(background);
+  /* The pipeline has been flushed, thus every frame has been checked. */
+  if (args_h.get_duplicate_tolerance() >= 0) {
+    cout << labgen_p.get_skipped_frames() << " duplicate frames skipped, "
+         << labgen_p.get_reused_frames() << " near duplicates reused the "
+         << "quantities of motion." << endl << endl;
+  }
 
   cout << "Writing " << output_file.str() << "..." << endl;
   imwrite(output_file.str(), background);
 
+  /* The pipeline has been flushed, thus every frame is in the cache. Only the
+   * cache of a whole sequence is kept.
+   */
+  if (cache_writer != nullptr) {
+    if (labgen_p.has_converged()) {
+      cerr << "/!\\ The processing stopped before the end of the sequence, ";
+      cerr << "the motion cache will not be written!" << endl;
+    }
+    else {
+      cache_writer->commit(frame_hashes);
+      cout << "Motion cache " << args_h.get_motion_cache() << " written."
+           << endl;
+    }
+  }
+
+  /* The pipeline has been flushed, thus every background has been queued. */
+  if (writer != nullptr) {
+    writer->finish();
+
+    cout << writer->get_written() << " intermediate backgrounds written."
+         << endl;
+  }
+
   /* Cleaning. */
-  if (args_h.get_visualization()) {
-    cout << endl << "Press any key in a graphical window to quit..." << endl;
-    waitKey(0);
-    destroyAllWindows();
+  if (visualizer != nullptr) {
+    /* The last frame is always rendered, even if the previous ones were not,
+     * along with the final background.
+     */
+    if (frames_count > 1) {
+      AsyncLaBGen_P::BackgroundSnapshotPtr published =
+        labgen_p.get_background_snapshot();
+
+      shared_ptr<AsyncLaBGen_P::BackgroundSnapshot> final_background =
+        make_shared<AsyncLaBGen_P::BackgroundSnapshot>();
+
+      final_background->background = background;
+      final_background->epoch =
+        (published != nullptr) ? published->epoch + 1 : 1;
+      final_background->inserted_frames = labgen_p.get_inserted_frames();
+
+      publish_snapshot(last_frame, final_background);
+    }
+
+    if (args_h.get_visualization())
+      cout << endl << "Press any key in a graphical window to quit..." << endl;
 
-    if (args_h.get_record())
-      record_stream->release();
+    visualizer->finish(args_h.get_visualization());
   }
 
   /* Bye. */
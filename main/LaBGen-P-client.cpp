@@ -0,0 +1,147 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+#include <boost/program_options.hpp>
+
+#include <labgen-p/BatchRunner.hpp>
+#include <labgen-p/JobProtocol.hpp>
+
+using namespace std;
+using namespace boost::program_options;
+using namespace ns_labgen_p;
+
+/******************************************************************************
+ * Main program                                                               *
+ ******************************************************************************/
+
+/*
+ * Minimal client of LaBGen-P-daemon: sends a job and waits for its result.
+ */
+int main(int argc, char** argv) {
+  options_description opt_desc(
+    "LaBGen-P - Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017\n"
+    "http://www.montefiore.ulg.ac.be/~blaugraud\n"
+    "http://www.telecom.ulg.ac.be/labgen\n\n"
+    "Usage: ./LaBGen-P-client [options]"
+  );
+
+  opt_desc.add_options()
+    (
+      "help",
+      "print this help message"
+    )
+    (
+      "socket",
+      value<string>()->default_value("/tmp/labgen-p.sock"),
+      "path of the Unix domain socket of the daemon"
+    )
+    (
+      "input,i",
+      value<string>(),
+      "path to the input sequence, as seen by the daemon"
+    )
+    (
+      "output,o",
+      value<string>(),
+      "path of the background to write, as seen by the daemon"
+    )
+    (
+      "s-parameter,s",
+      value<int32_t>(),
+      "value of the S parameter"
+    )
+    (
+      "n-parameter,n",
+      value<int32_t>(),
+      "value of the N parameter"
+    )
+    (
+      "motion-scale,m",
+      value<int32_t>()->default_value(1),
+      "downscaling factor (1, 2 or 4) of the frames used to estimate the "
+      "quantities of motion"
+    )
+    (
+      "priority,p",
+      value<int32_t>()->default_value(0),
+      "priority of the job, the highest ones being processed first"
+    )
+  ;
+
+  variables_map vars_map;
+  store(parse_command_line(argc, argv, opt_desc), vars_map);
+  notify(vars_map);
+
+  if (
+    vars_map.count("help")         ||
+    !vars_map.count("input")       ||
+    !vars_map.count("output")      ||
+    !vars_map.count("s-parameter") ||
+    !vars_map.count("n-parameter")
+  ) {
+    cout << opt_desc << endl;
+    return vars_map.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  BatchRunner::Job job;
+  job.input = vars_map["input"].as<string>();
+  job.output = vars_map["output"].as<string>();
+  job.s = vars_map["s-parameter"].as<int32_t>();
+  job.n = vars_map["n-parameter"].as<int32_t>();
+  job.motion_scale = vars_map["motion-scale"].as<int32_t>();
+
+  int daemon = JobProtocol::connect(vars_map["socket"].as<string>());
+  JobProtocol::Message response;
+
+  try {
+    JobProtocol::write(
+      daemon,
+      JobProtocol::encode_job(job, vars_map["priority"].as<int32_t>())
+    );
+
+    if (!JobProtocol::read(daemon, response))
+      throw runtime_error("The daemon closed the connection.");
+  }
+  catch (const exception& e) {
+    close(daemon);
+    cerr << "/!\\ " << e.what() << endl;
+
+    return EXIT_FAILURE;
+  }
+
+  close(daemon);
+  BatchRunner::Result result = JobProtocol::decode_result(response);
+
+  cout << (result.success ? "Done: " : "Failed: ") << result.message << endl;
+  cout << "           frames: " << result.frames << endl;
+  cout << "       queued (s): " << result.queued_seconds << endl;
+  cout << "   processing (s): " << result.processing_seconds << endl;
+
+  return result.success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
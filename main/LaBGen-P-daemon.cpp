@@ -0,0 +1,301 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <boost/program_options.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <labgen-p/BatchRunner.hpp>
+#include <labgen-p/JobProtocol.hpp>
+
+using namespace cv;
+using namespace std;
+using namespace boost::program_options;
+using namespace ns_labgen_p;
+
+/******************************************************************************
+ * Signal handling                                                            *
+ ******************************************************************************/
+
+volatile sig_atomic_t stop_requested = 0;
+
+void request_stop(int) {
+  stop_requested = 1;
+}
+
+/******************************************************************************
+ * Main program                                                               *
+ ******************************************************************************/
+
+/*
+ * Persistent daemon: keeps a pool of threads and LaBGen-P instances alive, and
+ * processes the jobs sent by LaBGen-P-client over a Unix domain socket, by
+ * decreasing priority. It stops on SIGINT or SIGTERM, once the queued jobs are
+ * done.
+ */
+int main(int argc, char** argv) {
+  options_description opt_desc(
+    "LaBGen-P - Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017\n"
+    "http://www.montefiore.ulg.ac.be/~blaugraud\n"
+    "http://www.telecom.ulg.ac.be/labgen\n\n"
+    "Usage: ./LaBGen-P-daemon [options]"
+  );
+
+  opt_desc.add_options()
+    (
+      "help",
+      "print this help message"
+    )
+    (
+      "socket",
+      value<string>()->default_value("/tmp/labgen-p.sock"),
+      "path of the Unix domain socket to listen on"
+    )
+    (
+      "threads,j",
+      value<uint32_t>()->default_value(0),
+      "number of threads (0 for the number of cores)"
+    )
+    (
+      "max-idle-instances",
+      value<uint32_t>()->default_value(0),
+      "number of idle LaBGen-P instances kept between the jobs, the least "
+      "recently used ones being freed first (0 for the number of threads)"
+    )
+    (
+      "warm-up,w",
+      value<vector<int32_t>>()->multitoken(),
+      "allocate one history per thread for BGR sequences of the given "
+      "dimensions and parameters: <height> <width> <S> <N>"
+    )
+  ;
+
+  variables_map vars_map;
+  store(parse_command_line(argc, argv, opt_desc), vars_map);
+  notify(vars_map);
+
+  if (vars_map.count("help")) {
+    cout << opt_desc << endl;
+    return EXIT_SUCCESS;
+  }
+
+  BatchRunner runner(vars_map["threads"].as<uint32_t>());
+
+  if (runner.get_threads_count() > 1)
+    setNumThreads(0);
+
+  /* The histories of past jobs would otherwise be kept forever. */
+  size_t max_idle = vars_map["max-idle-instances"].as<uint32_t>();
+  runner.set_max_idle_instances(
+    (max_idle > 0) ? max_idle : runner.get_threads_count()
+  );
+
+  if (vars_map.count("warm-up")) {
+    vector<int32_t> warm_up = vars_map["warm-up"].as<vector<int32_t>>();
+
+    if (warm_up.size() != 4) {
+      cerr << "Four arguments must be provided with warm-up: "
+           << "<height> <width> <S> <N>" << endl;
+
+      return EXIT_FAILURE;
+    }
+
+    runner.warm_up(
+      warm_up[0],
+      warm_up[1],
+      warm_up[2],
+      warm_up[3],
+      1,
+      runner.get_threads_count()
+    );
+  }
+
+  /* The connections of gone clients must not kill the daemon. */
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, request_stop);
+  signal(SIGTERM, request_stop);
+
+  string path = vars_map["socket"].as<string>();
+  int server = JobProtocol::listen(path);
+
+  /* The jobs are logged by the threads of the pool. */
+  mutex log_mutex;
+
+  cout << "Listening on " << path << " with " << runner.get_threads_count()
+       << " threads..." << endl;
+
+  /* Answers a client whose request cannot be processed, and disconnects it.
+   */
+  auto reject = [](int client, const string& message) {
+    BatchRunner::Result result;
+    result.success = false;
+    result.message = message;
+    result.frames = 0;
+    result.queued_seconds = 0;
+    result.processing_seconds = 0;
+
+    try {
+      JobProtocol::write(client, JobProtocol::encode_result(result));
+    }
+    catch (const exception&) {}
+
+    close(client);
+  };
+
+  /* The client is answered and disconnected once its job is done. */
+  auto submit = [&](int client, const JobProtocol::Message& request) {
+    try {
+      int32_t priority;
+      BatchRunner::Job job = JobProtocol::decode_job(request, priority);
+
+      runner.submit(
+        job,
+        priority,
+        [client, &log_mutex](
+          const BatchRunner::Job& job,
+          const BatchRunner::Result& result
+        ) {
+          try {
+            JobProtocol::write(client, JobProtocol::encode_result(result));
+          }
+          catch (const exception&) {}
+
+          close(client);
+
+          lock_guard<mutex> lock(log_mutex);
+          cout << job.input << ": " << (result.success ? "ok" : "error")
+               << " (" << result.processing_seconds << " s)" << endl;
+        }
+      );
+    }
+    catch (const exception& e) {
+      reject(client, e.what());
+    }
+  };
+
+  /* The requests are read from all the connections at once, so that a slow
+   * client does not delay the others. A client has a few seconds to send its
+   * request.
+   */
+  struct Connection {
+    int socket;
+    string received;
+    chrono::steady_clock::time_point deadline;
+  };
+
+  vector<Connection> connections;
+
+  while (!stop_requested) {
+    vector<pollfd> polled(1 + connections.size());
+    polled[0] = { server, POLLIN, 0 };
+
+    for (size_t i = 0; i < connections.size(); ++i)
+      polled[i + 1] = { connections[i].socket, POLLIN, 0 };
+
+    /* Polling with a timeout to notice the stop requests and the deadlines. */
+    if (poll(polled.data(), polled.size(), 200) < 0)
+      continue;
+
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    vector<Connection> waiting;
+
+    for (size_t i = 0; i < connections.size(); ++i) {
+      Connection& connection = connections[i];
+
+      if (polled[i + 1].revents != 0) {
+        char buffer[4096];
+        ssize_t received =
+          recv(connection.socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+        if (received > 0)
+          connection.received.append(buffer, received);
+        else if (
+          (received == 0) ||
+          ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+        ) {
+          /* Closed before sending a whole request. */
+          close(connection.socket);
+          continue;
+        }
+      }
+
+      try {
+        JobProtocol::Message request;
+
+        if (JobProtocol::extract(connection.received, request)) {
+          submit(connection.socket, request);
+          continue;
+        }
+      }
+      catch (const exception& e) {
+        reject(connection.socket, e.what());
+        continue;
+      }
+
+      if (now >= connection.deadline) {
+        close(connection.socket);
+        continue;
+      }
+
+      waiting.push_back(move(connection));
+    }
+
+    connections.swap(waiting);
+
+    if (polled[0].revents & POLLIN) {
+      int client = accept(server, nullptr, nullptr);
+
+      if (client >= 0) {
+        Connection connection;
+        connection.socket = client;
+        connection.deadline = now + chrono::seconds(5);
+
+        connections.push_back(move(connection));
+      }
+    }
+  }
+
+  for (Connection& connection : connections)
+    close(connection.socket);
+
+  cout << "Stopping once the queued jobs are done..." << endl;
+
+  close(server);
+  unlink(path.c_str());
+  runner.wait();
+
+  return EXIT_SUCCESS;
+}
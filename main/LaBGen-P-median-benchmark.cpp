@@ -0,0 +1,328 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <labgen-p/FrameSource.hpp>
+#include <labgen-p/LaBGen_P.hpp>
+
+using namespace cv;
+using namespace std;
+using namespace boost::program_options;
+using namespace ns_labgen_p;
+
+/******************************************************************************
+ * Synthetic scene                                                            *
+ ******************************************************************************/
+
+/* Occluders moving over the scene, and their size. */
+static const int OCCLUDERS        = 4;
+static const int OCCLUDERS_HEIGHT = 20;
+static const int OCCLUDERS_WIDTH  = 25;
+
+/* Amplitude of the uniform noise added to every sample. */
+static const int NOISE = 5;
+
+/*
+ * Textured background, drawn once, from 40 to 209 so that the noise does not
+ * saturate.
+ */
+static Mat make_background(int height, int width, mt19937& generator) {
+  uniform_int_distribution<int> texture(40, 209);
+  Mat background(height, width, CV_8UC3);
+
+  for (size_t i = 0; i < background.total() * 3; ++i)
+    background.data[i] = static_cast<uint8_t>(texture(generator));
+
+  return background;
+}
+
+/******************************************************************************/
+
+/* Frame t of the sequence: the background covered by the occluders, with
+ * noise.
+ */
+static Mat make_frame(const Mat& background, int t, mt19937& generator) {
+  uniform_int_distribution<int> noise(-NOISE, NOISE);
+  Mat frame = background.clone();
+
+  for (int o = 0; o < OCCLUDERS; ++o) {
+    int min_x = (t * (2 + o) + o * 37) % frame.cols;
+    int min_y = (o * 23 + t / (3 + o)) % (frame.rows - OCCLUDERS_HEIGHT);
+    int max_x = min(frame.cols, min_x + OCCLUDERS_WIDTH);
+
+    for (int y = min_y; y < min_y + OCCLUDERS_HEIGHT; ++y) {
+      for (int x = min_x; x < max_x; ++x) {
+        uint8_t* pixel = frame.ptr(y) + (3 * x);
+        pixel[0] = pixel[1] = pixel[2] = static_cast<uint8_t>(o * 60);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < frame.total() * 3; ++i) {
+    frame.data[i] = static_cast<uint8_t>(
+      max(0, min(255, frame.data[i] + noise(generator)))
+    );
+  }
+
+  return frame;
+}
+
+/******************************************************************************
+ * Comparison                                                                 *
+ ******************************************************************************/
+
+/* Mean absolute difference of two 8-bit images. */
+static double mean_error(const Mat& a, const Mat& b) {
+  size_t samples = a.total() * a.channels();
+  double sum = 0;
+
+  for (size_t i = 0; i < samples; ++i)
+    sum += abs(static_cast<int>(a.data[i]) - b.data[i]);
+
+  return sum / samples;
+}
+
+/******************************************************************************/
+
+/* Percentage of the samples of two 8-bit images within 8 levels. */
+static double agreement(const Mat& a, const Mat& b) {
+  size_t samples = a.total() * a.channels();
+  size_t within = 0;
+
+  for (size_t i = 0; i < samples; ++i)
+    within += (abs(static_cast<int>(a.data[i]) - b.data[i]) <= 8);
+
+  return 100. * within / samples;
+}
+
+/******************************************************************************/
+
+/* Full and approximate histories fed with the same frames. */
+struct Comparison {
+  LaBGen_P full;
+  LaBGen_P approximate;
+  double full_seconds;
+  double approximate_seconds;
+
+  Comparison(int height, int width, int32_t s, int32_t n) :
+  full(height, width, s, n),
+  approximate(height, width, s, n),
+  full_seconds(0),
+  approximate_seconds(0) {
+    approximate.approximate_median();
+  }
+
+  void insert(const Mat& frame) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    full.insert(frame);
+    chrono::steady_clock::time_point middle = chrono::steady_clock::now();
+    approximate.insert(frame);
+
+    full_seconds +=
+      chrono::duration<double>(middle - start).count();
+    approximate_seconds +=
+      chrono::duration<double>(chrono::steady_clock::now() - middle).count();
+  }
+
+  void report(const string& name, const Mat* truth) {
+    Mat full_background;
+    Mat approximate_background;
+
+    full.generate_background(full_background);
+    approximate.generate_background(approximate_background);
+
+    printf(
+      "%-28s %7.2f %7.2f",
+      name.c_str(),
+      full_seconds,
+      approximate_seconds
+    );
+
+    if (truth != nullptr) {
+      printf(
+        " %7.2f %7.2f",
+        mean_error(full_background, *truth),
+        mean_error(approximate_background, *truth)
+      );
+    }
+    else
+      printf(" %7s %7s", "-", "-");
+
+    printf(
+      " %7.2f %8.1f%%\n",
+      mean_error(full_background, approximate_background),
+      agreement(full_background, approximate_background)
+    );
+  }
+};
+
+/******************************************************************************
+ * Main program                                                               *
+ ******************************************************************************/
+
+/*
+ * Compares the approximate median history with the full one, on a synthetic
+ * scene whose true background is known, then on the given sequences. For each
+ * S, it reports the insertion times, the mean absolute error of each
+ * background to the true one, and the error and agreement (within 8 levels)
+ * between both backgrounds.
+ */
+int main(int argc, char** argv) {
+  options_description opt_desc(
+    "LaBGen-P - Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017\n"
+    "http://www.montefiore.ulg.ac.be/~blaugraud\n"
+    "http://www.telecom.ulg.ac.be/labgen\n\n"
+    "Usage: ./LaBGen-P-median-benchmark [options] [sequences]"
+  );
+
+  opt_desc.add_options()
+    (
+      "help",
+      "print this help message"
+    )
+    (
+      "s-parameter,s",
+      value<vector<int32_t>>(),
+      "value of the S parameter, repeated for several values (19, 57 and 200 "
+      "by default)"
+    )
+    (
+      "n-parameter,n",
+      value<int32_t>()->default_value(2),
+      "value of the N parameter"
+    )
+    (
+      "height",
+      value<int32_t>()->default_value(96),
+      "height of the synthetic scene"
+    )
+    (
+      "width",
+      value<int32_t>()->default_value(128),
+      "width of the synthetic scene"
+    )
+    (
+      "frames",
+      value<int32_t>()->default_value(300),
+      "number of frames of the synthetic scene"
+    )
+    (
+      "seed",
+      value<uint32_t>()->default_value(3),
+      "seed of the synthetic scene"
+    )
+    (
+      "input,i",
+      value<vector<string>>(),
+      "sequences to compare the histories on, without a true background"
+    )
+  ;
+
+  positional_options_description pos_desc;
+  pos_desc.add("input", -1);
+
+  variables_map vars_map;
+  store(
+    command_line_parser(argc, argv)
+      .options(opt_desc)
+      .positional(pos_desc)
+      .run(),
+    vars_map
+  );
+  notify(vars_map);
+
+  if (vars_map.count("help")) {
+    cout << opt_desc << endl;
+    return EXIT_SUCCESS;
+  }
+
+  vector<int32_t> s_values = { 19, 57, 200 };
+
+  if (vars_map.count("s-parameter"))
+    s_values = vars_map["s-parameter"].as<vector<int32_t>>();
+
+  int32_t n = vars_map["n-parameter"].as<int32_t>();
+  int32_t height = vars_map["height"].as<int32_t>();
+  int32_t width = vars_map["width"].as<int32_t>();
+  int32_t frames = vars_map["frames"].as<int32_t>();
+
+  if (
+    (height <= OCCLUDERS_HEIGHT) || (width <= 0) || (frames <= 0) || (n <= 0)
+  ) {
+    cerr << "The synthetic scene must be taller than " << OCCLUDERS_HEIGHT
+         << " rows, and its width, frames and N positive." << endl;
+    return EXIT_FAILURE;
+  }
+
+  printf(
+    "%-28s %7s %7s %7s %7s %7s %9s\n",
+    "", "full s", "appr s", "full", "appr", "diff", "within 8"
+  );
+
+  for (int32_t s : s_values) {
+    mt19937 generator(vars_map["seed"].as<uint32_t>());
+    Mat truth = make_background(height, width, generator);
+    Comparison comparison(height, width, s, n);
+
+    for (int32_t t = 0; t < frames; ++t)
+      comparison.insert(make_frame(truth, t, generator));
+
+    comparison.report("synthetic S=" + to_string(s), &truth);
+  }
+
+  if (vars_map.count("input")) {
+    for (const string& input : vars_map["input"].as<vector<string>>()) {
+      for (int32_t s : s_values) {
+        FrameSource::FrameSourcePtr source = FrameSource::open(input);
+        Comparison comparison(
+          source->get_height(),
+          source->get_width(),
+          s,
+          n
+        );
+
+        Mat frame;
+
+        while (source->read(frame)) {
+          comparison.insert(frame);
+          frame.release();
+        }
+
+        string name = input.substr(input.find_last_of('/') + 1);
+        comparison.report(name.substr(0, 20) + " S=" + to_string(s), nullptr);
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
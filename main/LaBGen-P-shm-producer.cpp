@@ -0,0 +1,131 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <boost/program_options.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <labgen-p/FrameSource.hpp>
+#include <labgen-p/SharedFrameRing.hpp>
+
+using namespace cv;
+using namespace std;
+using namespace boost::program_options;
+using namespace ns_labgen_p;
+
+/******************************************************************************
+ * Main program                                                               *
+ ******************************************************************************/
+
+/*
+ * Reference producer of a SharedFrameRing: decodes a sequence once and
+ * publishes its frames, so that several LaBGen-P-cli processes can read them
+ * with "-i shm:<name>".
+ */
+int main(int argc, char** argv) {
+  options_description opt_desc(
+    "LaBGen-P - Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017\n"
+    "http://www.montefiore.ulg.ac.be/~blaugraud\n"
+    "http://www.telecom.ulg.ac.be/labgen\n\n"
+    "Usage: ./LaBGen-P-shm-producer [options]"
+  );
+
+  opt_desc.add_options()
+    (
+      "help",
+      "print this help message"
+    )
+    (
+      "input,i",
+      value<string>(),
+      "path to the input sequence (\"-\" for the standard input)"
+    )
+    (
+      "name,n",
+      value<string>()->default_value("/labgen-p"),
+      "name of the shared memory object to create"
+    )
+    (
+      "slots,s",
+      value<uint32_t>()->default_value(16),
+      "number of frames held by the ring"
+    )
+    (
+      "fps,f",
+      value<double>()->default_value(0.),
+      "frames published per second (0 for as fast as possible)"
+    )
+  ;
+
+  variables_map vars_map;
+  store(parse_command_line(argc, argv, opt_desc), vars_map);
+  notify(vars_map);
+
+  if (vars_map.count("help") || !vars_map.count("input")) {
+    cout << opt_desc << endl;
+    return vars_map.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  /* 4:2:0 frames are published as is: readers convert them if needed. */
+  FrameSource::FrameSourcePtr source =
+    FrameSource::open(vars_map["input"].as<string>(), 1, Size(), true);
+
+  SharedFrameRing ring(
+    vars_map["name"].as<string>(),
+    source->get_height(),
+    source->get_width(),
+    source->get_pixel_format(),
+    vars_map["slots"].as<uint32_t>()
+  );
+
+  cout << "Publishing in shm:" << vars_map["name"].as<string>() << "..."
+       << endl;
+
+  double fps = vars_map["fps"].as<double>();
+  chrono::steady_clock::time_point deadline = chrono::steady_clock::now();
+  size_t frames_count = 0;
+  Mat frame;
+
+  while (source->read(frame)) {
+    if (fps > 0.) {
+      deadline += chrono::duration_cast<chrono::steady_clock::duration>(
+        chrono::duration<double>(1. / fps)
+      );
+
+      this_thread::sleep_until(deadline);
+    }
+
+    ring.publish(frame);
+    ++frames_count;
+  }
+
+  /* Readers stop once they have read the remaining frames. */
+  ring.close();
+  cout << frames_count << " frames published." << endl;
+
+  return EXIT_SUCCESS;
+}
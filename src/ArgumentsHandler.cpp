@@ -66,6 +66,19 @@ void ArgumentsHandler::parse_vars_map() {
   parse_default_params();
   parse_s_param();
   parse_n_param();
+  parse_motion_scale();
+  parse_motion_threshold();
+  parse_detector();
+  parse_reduction();
+  parse_raw_size();
+  parse_native_yuv();
+  parse_subsample_chroma();
+  parse_approximate_median();
+  parse_stop_when_stable();
+  parse_coarse_to_fine();
+  parse_output_every();
+  parse_motion_cache();
+  parse_skip_duplicates();
   parse_visualization();
   parse_split_vis();
   parse_record();
@@ -101,6 +114,108 @@ int32_t ArgumentsHandler::get_n_param() const {
 
 /******************************************************************************/
 
+int32_t ArgumentsHandler::get_motion_scale() const {
+  return motion_scale;
+}
+
+/******************************************************************************/
+
+int32_t ArgumentsHandler::get_motion_threshold() const {
+  return motion_threshold;
+}
+
+/******************************************************************************/
+
+const string& ArgumentsHandler::get_detector() const {
+  return detector;
+}
+
+/******************************************************************************/
+
+int32_t ArgumentsHandler::get_reduction() const {
+  return reduction;
+}
+
+/******************************************************************************/
+
+int32_t ArgumentsHandler::get_raw_height() const {
+  return raw_height;
+}
+
+/******************************************************************************/
+
+int32_t ArgumentsHandler::get_raw_width() const {
+  return raw_width;
+}
+
+/******************************************************************************/
+
+bool ArgumentsHandler::get_native_yuv() const {
+  return native_yuv;
+}
+
+/******************************************************************************/
+
+bool ArgumentsHandler::get_subsample_chroma() const {
+  return subsample_chroma;
+}
+
+/******************************************************************************/
+
+bool ArgumentsHandler::get_approximate_median() const {
+  return approximate_median;
+}
+
+/******************************************************************************/
+
+int32_t ArgumentsHandler::get_stability_window() const {
+  return stability_window;
+}
+
+/******************************************************************************/
+
+double ArgumentsHandler::get_max_changes() const {
+  return max_changes;
+}
+
+/******************************************************************************/
+
+double ArgumentsHandler::get_max_motion() const {
+  return max_motion;
+}
+
+/******************************************************************************/
+
+bool ArgumentsHandler::get_coarse_to_fine() const {
+  return coarse_to_fine;
+}
+
+/******************************************************************************/
+
+int32_t ArgumentsHandler::get_output_every() const {
+  return output_every;
+}
+
+/******************************************************************************/
+
+const string& ArgumentsHandler::get_output_stream() const {
+  return output_stream;
+}
+
+/******************************************************************************/
+
+const string& ArgumentsHandler::get_motion_cache() const {
+  return motion_cache;
+}
+
+/******************************************************************************/
+
+double ArgumentsHandler::get_duplicate_tolerance() const {
+  return duplicate_tolerance;
+}
+
+/******************************************************************************/
+
 bool ArgumentsHandler::get_visualization() const {
   return visualization;
 }
@@ -160,6 +275,32 @@ void ArgumentsHandler::print_parameters(ostream& os) const {
   os << "      Output path: "      << output        << endl;
   os << "                S: "      << s_param       << endl;
   os << "                N: "      << n_param       << endl;
+  os << "     Motion scale: "      << motion_scale  << endl;
+  if (motion_threshold >= 0)
+  os << " Motion threshold: "      << motion_threshold << endl;
+  os << "         Detector: "      << detector      << endl;
+  if (reduction > 1)
+  os << "        Reduction: "      << reduction     << endl;
+  if (raw_height > 0)
+  os << "   Raw frame size: "      << raw_height << "x" << raw_width << endl;
+  os << "       Native YUV: "      << native_yuv    << endl;
+  if (native_yuv)
+  os << " Subsample chroma: "      << subsample_chroma << endl;
+  os << "   Approx. median: "      << approximate_median << endl;
+  if (stability_window > 0) {
+  os << " Stability window: "      << stability_window << endl;
+  os << "Stability changes: "      << max_changes   << endl;
+  os << " Stability motion: "      << max_motion    << endl;
+  }
+  os << "   Coarse to fine: "      << coarse_to_fine << endl;
+  if (output_every > 0)
+  os << "     Output every: "      << output_every  << endl;
+  if (!output_stream.empty())
+  os << "    Output stream: "      << output_stream << endl;
+  if (!motion_cache.empty())
+  os << "     Motion cache: "      << motion_cache  << endl;
+  if (duplicate_tolerance >= 0)
+  os << "  Skip duplicates: "      << duplicate_tolerance << endl;
   os << "    Visualization: "      << visualization << endl;
   if (visualization)
   os << "        Split vis: "      << split_vis     << endl;
@@ -190,7 +331,8 @@ void ArgumentsHandler::define_options() {
     (
       "input,i",
       value<string>(),
-      "path to the input sequence"
+      "path to the input sequence (\"-\" for the standard input, "
+      "\"shm:<name>\" for a shared frame ring)"
     )
     (
       "output,o",
@@ -211,6 +353,102 @@ void ArgumentsHandler::define_options() {
       "default,d",
       "use the default set of parameters"
     )
+    (
+      "motion-scale,m",
+      value<int32_t>()->default_value(1),
+      "downscaling factor (1, 2 or 4) of the frames used to estimate the "
+      "quantities of motion"
+    )
+    (
+      "motion-threshold",
+      value<int32_t>(),
+      "count the pixels whose absolute difference is larger than the given "
+      "threshold (0 to 254) in the windows of the quantities of motion, "
+      "instead of summing the differences, which is faster and more robust "
+      "to noise"
+    )
+    (
+      "detector",
+      value<string>()->default_value("c1l1"),
+      "frame difference used to detect motion, on the luma (c1l1) or on the "
+      "B, G, R channels with the L1 (c3l1) or L2 (c3l2) norm; the color "
+      "ones need color frames, the others being processed with c1l1"
+    )
+    (
+      "reduction,e",
+      value<int32_t>()->default_value(1),
+      "process the sequence at its size divided by a factor (1, 2, 4 or 8); "
+      "JPEG images are then decoded directly at the reduced size"
+    )
+    (
+      "raw-size",
+      value<vector<int32_t>>()->multitoken(),
+      "read the input as raw BGR frames of the given size: <height> <width>"
+    )
+    (
+      "native-yuv",
+      "process 4:2:0 YUV and gray inputs (Y4M or shared frame rings) "
+      "without converting them to BGR; only a YUV background is converted"
+    )
+    (
+      "subsample-chroma",
+      "with native-yuv, keep the chroma history of 2x2 blocks of pixels "
+      "instead of every pixel, which saves memory"
+    )
+    (
+      "approximate-median",
+      "estimate the median of the samples with the lowest quantities of "
+      "motion with a memory that does not depend on S (138 bytes per BGR "
+      "pixel), instead of keeping the S samples of each pixel"
+    )
+    (
+      "stop-when-stable",
+      value<int32_t>()->implicit_value(100),
+      "stop the processing once the background has been stable for the "
+      "given number of frames (100 if omitted)"
+    )
+    (
+      "stability-thresholds",
+      value<vector<double>>()->multitoken(),
+      "thresholds of stop-when-stable over the window: <mean ratio of pixels "
+      "whose history improves per frame> <mean variation of the background> "
+      "(0.05 and 0.5 by default)"
+    )
+    (
+      "coarse-to-fine",
+      "with an image sequence, a Y4M or a raw file, process the pairs of "
+      "consecutive frames every 64 pairs, then every 32 pairs, and so on, "
+      "writing the background after each pass, so that a first background "
+      "is quickly available"
+    )
+    (
+      "output-every",
+      value<int32_t>(),
+      "write the background every K inserted frames, as a PNG image named "
+      "after the number of inserted frames, without stalling the processing"
+    )
+    (
+      "output-stream",
+      value<string>(),
+      "with output-every, write the backgrounds to the standard output as a "
+      "raw (\"raw\") or Y4M (\"y4m\") stream instead of images; the messages "
+      "then go to the standard error"
+    )
+    (
+      "motion-cache",
+      value<string>(),
+      "path to a cache of the quantities of motion of the sequence, which "
+      "is written by a first run and read by the next ones with the same "
+      "input, N, motion scale, motion threshold and detector, whatever S"
+    )
+    (
+      "skip-duplicates",
+      value<double>()->implicit_value(0),
+      "skip the frames identical to the previous one, and reuse the "
+      "quantities of motion for the frames whose means of 16x16 blocks "
+      "differ by at most the given tolerance (0 if omitted, in gray levels) "
+      "from the last frame whose motion was computed"
+    )
     (
       "visualization,v",
       "enable visualization"
@@ -306,6 +544,221 @@ void ArgumentsHandler::parse_n_param() {
 
 /******************************************************************************/
 
+void ArgumentsHandler::parse_motion_scale() {
+  motion_scale = vars_map["motion-scale"].as<int32_t>();
+
+  if ((motion_scale != 1) && (motion_scale != 2) && (motion_scale != 4))
+    throw logic_error("The motion scale must be 1, 2 or 4!");
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_motion_threshold() {
+  motion_threshold = -1;
+
+  if (vars_map.count("motion-threshold")) {
+    motion_threshold = vars_map["motion-threshold"].as<int32_t>();
+
+    if ((motion_threshold < 0) || (motion_threshold > 254))
+      throw logic_error("The motion threshold must be between 0 and 254!");
+  }
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_detector() {
+  detector = vars_map["detector"].as<string>();
+
+  if ((detector != "c1l1") && (detector != "c3l1") && (detector != "c3l2"))
+    throw logic_error("The detector must be \"c1l1\", \"c3l1\" or \"c3l2\"!");
+
+  if ((detector != "c1l1") && (motion_threshold >= 0)) {
+    cerr << "/!\\ The detector option with motion-threshold will be ";
+    cerr << "ignored!" << endl << endl;
+
+    detector = "c1l1";
+  }
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_reduction() {
+  reduction = vars_map["reduction"].as<int32_t>();
+
+  if (
+    (reduction != 1) && (reduction != 2) &&
+    (reduction != 4) && (reduction != 8)
+  ) {
+    throw logic_error("The reduction factor must be 1, 2, 4 or 8!");
+  }
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_raw_size() {
+  raw_height = 0;
+  raw_width = 0;
+
+  if (vars_map.count("raw-size")) {
+    vector<int32_t> raw_size = vars_map["raw-size"].as<vector<int32_t>>();
+
+    if (raw_size.size() != 2) {
+      throw logic_error(
+        "Two arguments must be provided with raw-size: <height> <width>"
+      );
+    }
+
+    raw_height = raw_size[0];
+    raw_width = raw_size[1];
+
+    if ((raw_height < 1) || (raw_width < 1))
+      throw logic_error("The size of raw frames must be positive!");
+  }
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_native_yuv() {
+  native_yuv = vars_map.count("native-yuv");
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_subsample_chroma() {
+  subsample_chroma = vars_map.count("subsample-chroma");
+
+  if (subsample_chroma && !native_yuv) {
+    cerr << "/!\\ The subsample-chroma option without native-yuv will be ";
+    cerr << "ignored!" << endl << endl;
+
+    subsample_chroma = false;
+  }
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_approximate_median() {
+  approximate_median = vars_map.count("approximate-median");
+
+  if (approximate_median && subsample_chroma) {
+    cerr << "/!\\ The subsample-chroma option has no effect with ";
+    cerr << "approximate-median!" << endl << endl;
+  }
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_stop_when_stable() {
+  stability_window = 0;
+  max_changes = 0.05;
+  max_motion = 0.5;
+
+  if (vars_map.count("stop-when-stable")) {
+    stability_window = vars_map["stop-when-stable"].as<int32_t>();
+
+    if (stability_window < 1)
+      throw logic_error("The stability window must be positive!");
+  }
+
+  if (vars_map.count("stability-thresholds")) {
+    vector<double> thresholds =
+      vars_map["stability-thresholds"].as<vector<double>>();
+
+    if (thresholds.size() != 2) {
+      throw logic_error(
+        "Two arguments must be provided with stability-thresholds: "
+        "<changes> <motion>"
+      );
+    }
+
+    max_changes = thresholds[0];
+    max_motion = thresholds[1];
+
+    if ((max_changes < 0) || (max_motion < 0))
+      throw logic_error("The stability thresholds cannot be negative!");
+
+    if (stability_window == 0) {
+      cerr << "/!\\ The stability-thresholds option without ";
+      cerr << "stop-when-stable will be ignored!" << endl << endl;
+    }
+  }
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_coarse_to_fine() {
+  coarse_to_fine = vars_map.count("coarse-to-fine");
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_output_every() {
+  output_every = 0;
+  output_stream = "";
+
+  if (vars_map.count("output-every")) {
+    output_every = vars_map["output-every"].as<int32_t>();
+
+    if (output_every < 1)
+      throw logic_error("The output period must be positive!");
+  }
+
+  if (vars_map.count("output-stream")) {
+    output_stream = vars_map["output-stream"].as<string>();
+
+    if ((output_stream != "raw") && (output_stream != "y4m"))
+      throw logic_error("The output stream must be \"raw\" or \"y4m\"!");
+
+    if (output_every == 0) {
+      cerr << "/!\\ The output-stream option without output-every will be ";
+      cerr << "ignored!" << endl << endl;
+
+      output_stream = "";
+    }
+  }
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_motion_cache() {
+  motion_cache = "";
+
+  if (vars_map.count("motion-cache")) {
+    motion_cache = vars_map["motion-cache"].as<string>();
+
+    if (motion_cache.empty())
+      throw logic_error("The motion cache path cannot be empty!");
+  }
+}
+
+/******************************************************************************/
+
+void ArgumentsHandler::parse_skip_duplicates() {
+  duplicate_tolerance = -1;
+
+  if (vars_map.count("skip-duplicates")) {
+    duplicate_tolerance = vars_map["skip-duplicates"].as<double>();
+
+    if (duplicate_tolerance < 0)
+      throw logic_error("The tolerance of the duplicates cannot be negative!");
+
+    if (coarse_to_fine) {
+      cerr << "/!\\ The skip-duplicates option with coarse-to-fine will be ";
+      cerr << "ignored!" << endl << endl;
+
+      duplicate_tolerance = -1;
+    }
+    else if (!motion_cache.empty()) {
+      cerr << "/!\\ The motion-cache option with skip-duplicates will be ";
+      cerr << "ignored!" << endl << endl;
+
+      motion_cache = "";
+    }
+  }
+}
+
+/******************************************************************************/
+
 void ArgumentsHandler::parse_visualization() {
   visualization = vars_map.count("visualization");
 }
@@ -0,0 +1,354 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+#include <labgen-p/AsyncLaBGen_P.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+
+/* ========================================================================== *
+ * AsyncLaBGen_P                                                              *
+ * ========================================================================== */
+
+AsyncLaBGen_P::AsyncLaBGen_P(
+  size_t height,
+  size_t width,
+  int32_t s,
+  int32_t n,
+  int32_t motion_scale,
+  size_t depth
+) :
+LaBGen_P(height, width, s, n, motion_scale),
+motion_queue(depth),
+history_queue(depth),
+pool(depth),
+pending(0),
+failure(nullptr) {
+  for (size_t i = 0; i < depth; ++i) {
+    StageBuffers buffers;
+    buffers.motion_map =
+      Mat(motion_map.rows, motion_map.cols, motion_map.type(), Scalar(0));
+    buffers.quantities_of_motion =
+      Mat(quantities_of_motion.size(), quantities_of_motion.type());
+
+    pool.push(move(buffers));
+  }
+
+  motion_thread  = thread(&AsyncLaBGen_P::motion_stage, this);
+  history_thread = thread(&AsyncLaBGen_P::history_stage, this);
+}
+
+/******************************************************************************/
+
+AsyncLaBGen_P::~AsyncLaBGen_P() {
+  motion_queue.close();
+  motion_thread.join();
+
+  history_queue.close();
+  history_thread.join();
+}
+
+/******************************************************************************/
+
+future<void> AsyncLaBGen_P::submit(const Mat& current_frame) {
+  return submit(current_frame, get_pixel_format(current_frame));
+}
+
+/******************************************************************************/
+
+future<void> AsyncLaBGen_P::submit(
+  const Mat& current_frame,
+  PixelFormat format
+) {
+  check_frame(current_frame, format);
+  fix_color_space(format);
+
+  Job job;
+  job.frame = current_frame;
+  job.format = format;
+
+  return enqueue(job);
+}
+
+/******************************************************************************/
+
+future<void> AsyncLaBGen_P::submit_pair(
+  const Mat& previous_frame,
+  const Mat& frame
+) {
+  return submit_pair(previous_frame, frame, get_pixel_format(frame));
+}
+
+/******************************************************************************/
+
+future<void> AsyncLaBGen_P::submit_pair(
+  const Mat& previous_frame,
+  const Mat& frame,
+  PixelFormat format
+) {
+  check_frame(previous_frame, format);
+  check_frame(frame, format);
+  fix_color_space(format);
+
+  /* Both frames are shared with the pipeline. */
+  Job job;
+  job.previous_frame = previous_frame;
+  job.frame = frame;
+  job.format = format;
+
+  return enqueue(job);
+}
+
+/******************************************************************************/
+
+future<void> AsyncLaBGen_P::submit_precomputed(
+  const Mat& quantities,
+  const Mat& frame,
+  PixelFormat format
+) {
+  check_frame(frame, format);
+  check_quantities_of_motion(quantities);
+  fix_color_space(format);
+
+  /* The quantities of motion are shared with the pipeline as well. */
+  Job job;
+  job.precomputed = quantities;
+  job.frame = frame;
+  job.format = format;
+
+  return enqueue(job);
+}
+
+/******************************************************************************/
+
+future<void> AsyncLaBGen_P::enqueue(Job& job) {
+  future<void> result = job.done.get_future();
+  job.repetition = REPETITION_NONE;
+
+  {
+    lock_guard<mutex> lock(pending_mutex);
+    ++pending;
+  }
+
+  if (!motion_queue.push(move(job))) {
+    complete(job);
+    throw runtime_error("Cannot submit a frame to a stopped pipeline");
+  }
+
+  return result;
+}
+
+/******************************************************************************/
+
+void AsyncLaBGen_P::flush() {
+  unique_lock<mutex> lock(pending_mutex);
+  pending_cond.wait(lock, [this] { return pending == 0; });
+
+  /* Report the first failure since the last flush, if any. */
+  if (failure != nullptr) {
+    exception_ptr error = failure;
+    failure = nullptr;
+
+    rethrow_exception(error);
+  }
+}
+
+/******************************************************************************/
+
+void AsyncLaBGen_P::generate_background(Mat& background) {
+  flush();
+  LaBGen_P::generate_background(background);
+}
+
+/******************************************************************************/
+
+void AsyncLaBGen_P::update_background(Mat& background) {
+  flush();
+  LaBGen_P::update_background(background);
+}
+
+/******************************************************************************/
+
+void AsyncLaBGen_P::copy_motion(Mat& motion_map, Mat& quantities) const {
+  /* Unlike get_motion_map() and get_quantities_of_motion(), this does not
+   * require a flush, as the public buffers are swapped under the lock.
+   */
+  lock_guard<mutex> lock(public_buffers_mutex);
+
+  this->motion_map.copyTo(motion_map);
+  quantities_of_motion.copyTo(quantities);
+}
+
+/******************************************************************************/
+
+void AsyncLaBGen_P::motion_stage() {
+  Job job;
+
+  while (motion_queue.pop(job)) {
+    try {
+      pool.pop(job.buffers);
+
+      /* Only the frames submitted alone can repeat the previous ones. A
+       * duplicate is dropped there, while a near duplicate goes to the
+       * history, which inserts it with the last quantities of motion.
+       */
+      if (job.previous_frame.empty() && job.precomputed.empty())
+        job.repetition = check_repetition(job.frame);
+
+      if (job.repetition == REPETITION_EXACT) {
+        pool.push(move(job.buffers));
+        job.done.set_value();
+        complete(job);
+
+        continue;
+      }
+
+      if (job.repetition == REPETITION_NEAR) {
+        history_queue.push(move(job));
+        continue;
+      }
+
+      /* The quantities of motion of a previous run skip the frame difference
+       * and the filtering. The motion map of the buffers is left as is.
+       */
+      if (!job.precomputed.empty()) {
+        job.precomputed.copyTo(job.buffers.quantities_of_motion);
+        job.precomputed.release();
+        first_frame = false;
+
+        history_queue.push(move(job));
+        continue;
+      }
+
+      /* Motion map computation by frame difference, with the previous frame
+       * of the job if it has one.
+       */
+      if (!job.previous_frame.empty()) {
+        compute_difference(
+          job.previous_frame,
+          job.frame,
+          job.format,
+          job.buffers.motion_map
+        );
+
+        /* Only the second frame of the pair goes to the history. */
+        job.previous_frame.release();
+        first_frame = false;
+      }
+      else {
+        compute_difference(job.frame, job.format, job.buffers.motion_map);
+      }
+
+      /* Initialization of background subtraction. */
+      if (first_frame) {
+        first_frame = false;
+
+        pool.push(move(job.buffers));
+        job.done.set_value();
+        complete(job);
+
+        continue;
+      }
+
+      /* Filtering motion map to produce quantities of motion. */
+      compute_quantities(
+        job.buffers.motion_map,
+        job.buffers.quantities_of_motion
+      );
+
+      history_queue.push(move(job));
+    }
+    catch (...) {
+      if (!job.buffers.motion_map.empty())
+        pool.push(move(job.buffers));
+
+      job.done.set_exception(current_exception());
+      complete(job, current_exception());
+    }
+  }
+}
+
+/******************************************************************************/
+
+void AsyncLaBGen_P::history_stage() {
+  Job job;
+
+  while (history_queue.pop(job)) {
+    exception_ptr error = nullptr;
+
+    try {
+      /* Insert the current frame along with the quantities of motion into the
+       * history.
+       */
+      bool reused = (job.repetition == REPETITION_NEAR);
+
+      size_t changes = history->insert(
+        reused ? quantities_of_motion : job.buffers.quantities_of_motion,
+        job.frame,
+        job.format
+      );
+
+      /* The buffers of the last processed frame become the public ones, while
+       * the previous public ones go back to the pool. The public ones are
+       * kept for a near duplicate, whose buffers were left unused.
+       */
+      if (!reused) {
+        lock_guard<mutex> lock(public_buffers_mutex);
+
+        swap(motion_map, job.buffers.motion_map);
+        swap(quantities_of_motion, job.buffers.quantities_of_motion);
+      }
+
+      if (motion_callback)
+        motion_callback(quantities_of_motion);
+
+      count_inserted_frames(1, changes);
+      job.done.set_value();
+    }
+    catch (...) {
+      error = current_exception();
+      job.done.set_exception(error);
+    }
+
+    pool.push(move(job.buffers));
+    complete(job, error);
+  }
+}
+
+/******************************************************************************/
+
+void AsyncLaBGen_P::complete(Job& job, exception_ptr error) {
+  job.frame.release();
+
+  {
+    lock_guard<mutex> lock(pending_mutex);
+    --pending;
+
+    if ((error != nullptr) && (failure == nullptr))
+      failure = error;
+  }
+
+  pending_cond.notify_all();
+}
@@ -0,0 +1,209 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <sstream>
+#include <stdexcept>
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include <labgen-p/BackgroundWriter.hpp>
+#include <labgen-p/Utils.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+
+/* ========================================================================== *
+ * BackgroundWriter                                                           *
+ * ========================================================================== */
+
+BackgroundWriter::BackgroundWriter(const string& prefix, size_t depth) :
+format(FORMAT_IMAGE),
+prefix(prefix),
+stream(nullptr),
+written(0),
+queue(depth),
+failure(nullptr) {
+  writing_thread = thread(&BackgroundWriter::writing_loop, this);
+}
+
+/******************************************************************************/
+
+BackgroundWriter::BackgroundWriter(
+  Format format,
+  ostream& stream,
+  size_t depth
+) :
+format(format),
+prefix(),
+stream(&stream),
+written(0),
+queue(depth),
+failure(nullptr) {
+  if (format == FORMAT_IMAGE)
+    throw logic_error("The images are not written to a stream");
+
+  writing_thread = thread(&BackgroundWriter::writing_loop, this);
+}
+
+/******************************************************************************/
+
+BackgroundWriter::~BackgroundWriter() {
+  if (writing_thread.joinable()) {
+    try {
+      finish();
+    }
+    catch (...) {}
+  }
+}
+
+/******************************************************************************/
+
+void BackgroundWriter::write(const LaBGen_P::BackgroundSnapshotPtr& snapshot) {
+  /* Refused once the writer has stopped, the error being reported by
+   * finish().
+   */
+  queue.push(snapshot);
+}
+
+/******************************************************************************/
+
+void BackgroundWriter::finish() {
+  queue.close();
+  writing_thread.join();
+
+  if (failure != nullptr)
+    rethrow_exception(failure);
+}
+
+/******************************************************************************/
+
+size_t BackgroundWriter::get_written() const {
+  return written;
+}
+
+/******************************************************************************/
+
+void BackgroundWriter::writing_loop() {
+  LaBGen_P::BackgroundSnapshotPtr snapshot;
+
+  try {
+    while (queue.pop(snapshot)) {
+      switch (format) {
+        case FORMAT_RAW:
+          write_raw(snapshot->background);
+          break;
+
+        case FORMAT_Y4M:
+          write_y4m(snapshot->background);
+          break;
+
+        default:
+          write_image(*snapshot);
+          break;
+      }
+
+      /* The buffer of the snapshot can be recycled once released. */
+      snapshot.reset();
+      ++written;
+    }
+  }
+  catch (...) {
+    failure = current_exception();
+
+    /* The pending snapshots are released, and the next ones refused. */
+    queue.close();
+
+    while (queue.pop(snapshot)) {}
+  }
+}
+
+/******************************************************************************/
+
+void BackgroundWriter::write_image(
+  const LaBGen_P::BackgroundSnapshot& snapshot
+) {
+  stringstream file;
+  file << prefix << "_" << snapshot.inserted_frames << ".png";
+
+  if (!imwrite(file.str(), snapshot.background))
+    throw runtime_error("Cannot write the background '" + file.str() + "'");
+}
+
+/******************************************************************************/
+
+void BackgroundWriter::write_raw(const Mat& background) {
+  size_t row_size = background.cols * background.elemSize();
+
+  for (int y = 0; y < background.rows; ++y)
+    stream->write(reinterpret_cast<const char*>(background.ptr(y)), row_size);
+
+  stream->flush();
+
+  if (!*stream)
+    throw runtime_error("Cannot write the background stream");
+}
+
+/******************************************************************************/
+
+void BackgroundWriter::write_y4m(const Mat& background) {
+  /* 16-bit backgrounds are reduced to 8 bits. */
+  const Mat* input = &background;
+
+  if (background.depth() == CV_16U) {
+    Utils::reduce_depth(background, converted);
+    input = &converted;
+  }
+  else if (background.channels() == 3) {
+    Utils::bgr_to_yuv(background, converted);
+    input = &converted;
+  }
+
+  size_t channels = input->channels();
+
+  if (written == 0) {
+    *stream << "YUV4MPEG2 W" << input->cols << " H" << input->rows
+            << " F25:1 Ip A1:1 " << ((channels == 1) ? "Cmono" : "C444")
+            << "\n";
+  }
+
+  *stream << "FRAME\n";
+
+  /* The channels of the pixels are written plane by plane. */
+  plane.resize(static_cast<size_t>(input->rows) * input->cols);
+
+  for (size_t channel = 0; channel < channels; ++channel) {
+    uint8_t* plane_buffer = plane.data();
+
+    for (int y = 0; y < input->rows; ++y) {
+      const uint8_t* input_buffer = input->ptr(y) + channel;
+
+      for (int x = 0; x < input->cols; ++x, input_buffer += channels)
+        *(plane_buffer++) = *input_buffer;
+    }
+
+    stream->write(reinterpret_cast<const char*>(plane.data()), plane.size());
+  }
+
+  stream->flush();
+
+  if (!*stream)
+    throw runtime_error("Cannot write the background stream");
+}
@@ -0,0 +1,341 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include <boost/lexical_cast.hpp>
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include <labgen-p/BatchRunner.hpp>
+#include <labgen-p/FrameSource.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace cv;
+using namespace ns_labgen_p;
+
+/* ========================================================================== *
+ * BatchRunner                                                                *
+ * ========================================================================== */
+
+bool BatchRunner::QueuedJob::operator<(const QueuedJob& rhs) const {
+  /* The top of the queue is the first job of the highest priority. */
+  if (priority != rhs.priority)
+    return priority < rhs.priority;
+
+  return order > rhs.order;
+}
+
+/******************************************************************************/
+
+BatchRunner::BatchRunner(size_t threads_count) :
+submitted(0),
+max_idle(~static_cast<size_t>(0)),
+failures(0),
+pool(threads_count) {}
+
+/******************************************************************************/
+
+void BatchRunner::add(const Job& job) {
+  check(job);
+  jobs.push_back(job);
+}
+
+/******************************************************************************/
+
+void BatchRunner::load_manifest(const string& path) {
+  ifstream manifest(path);
+
+  if (!manifest)
+    throw runtime_error("Cannot open the manifest " + path);
+
+  string line;
+  size_t line_number = 0;
+
+  while (getline(manifest, line)) {
+    ++line_number;
+
+    istringstream fields(line);
+    Job job;
+    job.motion_scale = 1;
+
+    if (!(fields >> job.input) || (job.input[0] == '#'))
+      continue;
+
+    if (!(fields >> job.output >> job.s >> job.n)) {
+      throw logic_error(
+        "Line " + lexical_cast<string>(line_number) + " of the manifest "
+        "must be: <input> <output> <S> <N> [<motion scale>]"
+      );
+    }
+
+    fields >> job.motion_scale;
+    add(job);
+  }
+}
+
+/******************************************************************************/
+
+size_t BatchRunner::run(ostream& log) {
+  {
+    lock_guard<std::mutex> lock(mutex);
+    failures = 0;
+  }
+
+  for (const Job& job : jobs) {
+    submit(job, 0, [this, &log](const Job& job, const Result& result) {
+      lock_guard<std::mutex> lock(mutex);
+
+      if (result.success) {
+        log << job.input << ": " << result.frames << " frames processed, "
+            << job.output << " written." << endl;
+      }
+      else {
+        log << "/!\\ " << job.input << ": " << result.message << endl;
+        ++failures;
+      }
+    });
+  }
+
+  wait();
+  jobs.clear();
+
+  lock_guard<std::mutex> lock(mutex);
+  return failures;
+}
+
+/******************************************************************************/
+
+void BatchRunner::submit(const Job& job, int32_t priority, Callback callback) {
+  check(job);
+
+  {
+    lock_guard<std::mutex> lock(mutex);
+
+    QueuedJob queued_job;
+    queued_job.job = job;
+    queued_job.priority = priority;
+    queued_job.order = submitted++;
+    queued_job.submission = Clock::now();
+    queued_job.callback = move(callback);
+
+    queue.push(move(queued_job));
+  }
+
+  pool.submit([this] { dispatch(); });
+}
+
+/******************************************************************************/
+
+void BatchRunner::wait() {
+  pool.wait();
+}
+
+/******************************************************************************/
+
+BatchRunner::Result BatchRunner::process(const Job& job) {
+  Clock::time_point start = Clock::now();
+  Result result;
+  result.success = false;
+  result.frames = 0;
+  result.queued_seconds = 0;
+
+  InstanceKey key;
+  InstancePtr labgen_p;
+
+  try {
+    FrameSource::FrameSourcePtr source = FrameSource::open(job.input);
+
+    key = InstanceKey(
+      source->get_height(),
+      source->get_width(),
+      job.s,
+      job.n,
+      job.motion_scale
+    );
+
+    labgen_p = acquire(key);
+
+    /* LaBGen-P does not keep the frames, thus the buffer is reused. */
+    Mat frame;
+
+    while (source->read(frame)) {
+      labgen_p->insert(frame, source->get_pixel_format());
+      ++result.frames;
+    }
+
+    Mat background;
+    labgen_p->generate_background(background);
+
+    if (!imwrite(job.output, background))
+      throw runtime_error("Cannot write " + job.output);
+
+    result.success = true;
+    result.message = job.output + " written";
+  }
+  catch (const std::exception& e) {
+    result.message = e.what();
+  }
+
+  if (labgen_p != nullptr)
+    release(key, move(labgen_p));
+
+  result.processing_seconds =
+    chrono::duration<double>(Clock::now() - start).count();
+
+  return result;
+}
+
+/******************************************************************************/
+
+void BatchRunner::warm_up(
+  size_t height,
+  size_t width,
+  int32_t s,
+  int32_t n,
+  int32_t motion_scale,
+  size_t count
+) {
+  InstanceKey key(height, width, s, n, motion_scale);
+  vector<InstancePtr> warmed;
+
+  /* Instances with their history allocated for BGR frames. */
+  for (size_t i = 0; i < count; ++i) {
+    warmed.push_back(acquire(key));
+    warmed.back()->allocate_history(PixelFormat::BGR24);
+  }
+
+  for (InstancePtr& instance : warmed)
+    release(key, move(instance));
+}
+
+/******************************************************************************/
+
+void BatchRunner::set_max_idle_instances(size_t count) {
+  Instances evicted;
+
+  {
+    lock_guard<std::mutex> lock(mutex);
+    max_idle = count;
+
+    while (instances.size() > max_idle)
+      evicted.splice(evicted.end(), instances, instances.begin());
+  }
+}
+
+/******************************************************************************/
+
+size_t BatchRunner::get_threads_count() const {
+  return pool.size();
+}
+
+/******************************************************************************/
+
+void BatchRunner::check(const Job& job) {
+  if (job.s <= 0)
+    throw logic_error("The S parameter must be positive!");
+
+  if (job.n <= 0)
+    throw logic_error("The N parameter must be positive!");
+
+  if ((job.motion_scale != 1) && (job.motion_scale != 2) &&
+      (job.motion_scale != 4)) {
+    throw logic_error("The motion scale must be 1, 2 or 4!");
+  }
+}
+
+/******************************************************************************/
+
+void BatchRunner::dispatch() {
+  QueuedJob queued_job;
+
+  {
+    lock_guard<std::mutex> lock(mutex);
+
+    /* One task is submitted per job, thus the queue cannot be empty. */
+    queued_job = queue.top();
+    queue.pop();
+  }
+
+  Clock::time_point start = Clock::now();
+  Result result = process(queued_job.job);
+
+  result.queued_seconds =
+    chrono::duration<double>(start - queued_job.submission).count();
+
+  if (queued_job.callback)
+    queued_job.callback(queued_job.job, result);
+}
+
+/******************************************************************************/
+
+BatchRunner::InstancePtr BatchRunner::acquire(const InstanceKey& key) {
+  {
+    lock_guard<std::mutex> lock(mutex);
+
+    /* The most recently released instance of the key. */
+    for (
+      Instances::reverse_iterator it = instances.rbegin();
+      it != instances.rend();
+      ++it
+    ) {
+      if (it->first == key) {
+        InstancePtr instance = move(it->second);
+        instances.erase(std::next(it).base());
+
+        return instance;
+      }
+    }
+  }
+
+  return InstancePtr(
+    new LaBGen_P(
+      get<0>(key),
+      get<1>(key),
+      get<2>(key),
+      get<3>(key),
+      get<4>(key)
+    )
+  );
+}
+
+/******************************************************************************/
+
+void BatchRunner::release(const InstanceKey& key, InstancePtr instance) {
+  instance->reset();
+
+  /* The evicted instances are freed once the lock is released. */
+  Instances evicted;
+
+  {
+    lock_guard<std::mutex> lock(mutex);
+    instances.push_back(IdleInstance(key, move(instance)));
+
+    while (instances.size() > max_idle)
+      evicted.splice(evicted.end(), instances, instances.begin());
+  }
+}
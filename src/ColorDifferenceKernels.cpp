@@ -0,0 +1,326 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <labgen-p/ColorDifferenceKernels.hpp>
+
+/* SSSE3 kernels. The build gives -mssse3 to this file on x86. Otherwise, the
+ * target attribute is enough for clang and GCC since 4.9, but GCC 4.8 refuses
+ * the intrinsics and keeps the portable loops.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) &&                               \
+    (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (                                                                          \
+      defined(__SSSE3__) || defined(__clang__) ||                              \
+      (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))             \
+    )
+#define _LABGEN_P_SSSE3_KERNELS_
+#define _LABGEN_P_SSSE3_ __attribute__((target("ssse3")))
+#include <tmmintrin.h>
+#endif
+
+using namespace ns_labgen_p::ns_internals;
+
+#ifdef _LABGEN_P_SSSE3_KERNELS_
+/* Absolute differences of 16 pixels, one register per channel. */
+_LABGEN_P_SSSE3_
+static inline void load_differences(
+  const unsigned char* current_buffer,
+  const unsigned char* previous_buffer,
+  __m128i& b,
+  __m128i& g,
+  __m128i& r
+) {
+  const __m128i* current  =
+    reinterpret_cast<const __m128i*>(current_buffer);
+  const __m128i* previous =
+    reinterpret_cast<const __m128i*>(previous_buffer);
+
+  __m128i differences[3];
+
+  for (int i = 0; i < 3; ++i) {
+    __m128i c = _mm_loadu_si128(current + i);
+    __m128i p = _mm_loadu_si128(previous + i);
+
+    differences[i] = _mm_or_si128(_mm_subs_epu8(c, p), _mm_subs_epu8(p, c));
+  }
+
+  /* Byte k of channel c is at 3 * k + c in the 48 interleaved bytes. */
+  b = _mm_or_si128(
+    _mm_or_si128(
+      _mm_shuffle_epi8(
+        differences[0],
+        _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1,
+                      -1, -1, -1, -1, -1, -1, -1, -1)
+      ),
+      _mm_shuffle_epi8(
+        differences[1],
+        _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5,
+                      8, 11, 14, -1, -1, -1, -1, -1)
+      )
+    ),
+    _mm_shuffle_epi8(
+      differences[2],
+      _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
+                    -1, -1, -1, 1, 4, 7, 10, 13)
+    )
+  );
+
+  g = _mm_or_si128(
+    _mm_or_si128(
+      _mm_shuffle_epi8(
+        differences[0],
+        _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1,
+                      -1, -1, -1, -1, -1, -1, -1, -1)
+      ),
+      _mm_shuffle_epi8(
+        differences[1],
+        _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6,
+                      9, 12, 15, -1, -1, -1, -1, -1)
+      )
+    ),
+    _mm_shuffle_epi8(
+      differences[2],
+      _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
+                    -1, -1, -1, 2, 5, 8, 11, 14)
+    )
+  );
+
+  r = _mm_or_si128(
+    _mm_or_si128(
+      _mm_shuffle_epi8(
+        differences[0],
+        _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1,
+                      -1, -1, -1, -1, -1, -1, -1, -1)
+      ),
+      _mm_shuffle_epi8(
+        differences[1],
+        _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7,
+                      10, 13, -1, -1, -1, -1, -1, -1)
+      )
+    ),
+    _mm_shuffle_epi8(
+      differences[2],
+      _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
+                    -1, -1, 0, 3, 6, 9, 12, 15)
+    )
+  );
+}
+
+/******************************************************************************/
+
+/* (sum + 1) / 3 of 8 sums of differences, through a multiplication by
+ * 2^16 / 3 that is exact up to 3 * 255.
+ */
+_LABGEN_P_SSSE3_
+static inline void store_l1(__m128i sums, int32_t* motion_map_buffer) {
+  const __m128i zero = _mm_setzero_si128();
+
+  __m128i norms = _mm_mulhi_epu16(
+    _mm_add_epi16(sums, _mm_set1_epi16(1)),
+    _mm_set1_epi16(21846)
+  );
+
+  __m128i* output = reinterpret_cast<__m128i*>(motion_map_buffer);
+
+  _mm_storeu_si128(output,     _mm_unpacklo_epi16(norms, zero));
+  _mm_storeu_si128(output + 1, _mm_unpackhi_epi16(norms, zero));
+}
+
+/******************************************************************************/
+
+/* Rounded square root of the mean of 4 sums of squares, given as the B, G
+ * pairs and the R, 0 pairs of 16-bit differences. The single precision
+ * keeps the results of the table of the portable loop, no mean being close
+ * enough to a rounding boundary to be affected.
+ */
+_LABGEN_P_SSSE3_
+static inline void store_l2(
+  __m128i bg,
+  __m128i r0,
+  int32_t* motion_map_buffer
+) {
+  __m128i sums =
+    _mm_add_epi32(_mm_madd_epi16(bg, bg), _mm_madd_epi16(r0, r0));
+
+  __m128 norms = _mm_add_ps(
+    _mm_sqrt_ps(_mm_mul_ps(_mm_cvtepi32_ps(sums), _mm_set1_ps(1.f / 3))),
+    _mm_set1_ps(.5f)
+  );
+
+  _mm_storeu_si128(
+    reinterpret_cast<__m128i*>(motion_map_buffer),
+    _mm_cvttps_epi32(norms)
+  );
+}
+
+/******************************************************************************/
+
+_LABGEN_P_SSSE3_
+static int difference_l1_ssse3(
+  const unsigned char* current_buffer,
+  const unsigned char* previous_buffer,
+  int32_t* motion_map_buffer,
+  int cols
+) {
+  const __m128i zero = _mm_setzero_si128();
+  int x = 0;
+
+  for (; x + 16 <= cols; x += 16) {
+    __m128i b, g, r;
+
+    load_differences(
+      current_buffer + (3 * x),
+      previous_buffer + (3 * x),
+      b, g, r
+    );
+
+    store_l1(
+      _mm_add_epi16(
+        _mm_add_epi16(_mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(g, zero)),
+        _mm_unpacklo_epi8(r, zero)
+      ),
+      motion_map_buffer + x
+    );
+
+    store_l1(
+      _mm_add_epi16(
+        _mm_add_epi16(_mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(g, zero)),
+        _mm_unpackhi_epi8(r, zero)
+      ),
+      motion_map_buffer + x + 8
+    );
+  }
+
+  return x;
+}
+
+/******************************************************************************/
+
+_LABGEN_P_SSSE3_
+static int difference_l2_ssse3(
+  const unsigned char* current_buffer,
+  const unsigned char* previous_buffer,
+  int32_t* motion_map_buffer,
+  int cols
+) {
+  const __m128i zero = _mm_setzero_si128();
+  int x = 0;
+
+  for (; x + 16 <= cols; x += 16) {
+    __m128i b, g, r;
+
+    load_differences(
+      current_buffer + (3 * x),
+      previous_buffer + (3 * x),
+      b, g, r
+    );
+
+    __m128i b_low  = _mm_unpacklo_epi8(b, zero);
+    __m128i g_low  = _mm_unpacklo_epi8(g, zero);
+    __m128i r_low  = _mm_unpacklo_epi8(r, zero);
+    __m128i b_high = _mm_unpackhi_epi8(b, zero);
+    __m128i g_high = _mm_unpackhi_epi8(g, zero);
+    __m128i r_high = _mm_unpackhi_epi8(r, zero);
+
+    store_l2(
+      _mm_unpacklo_epi16(b_low, g_low),
+      _mm_unpacklo_epi16(r_low, zero),
+      motion_map_buffer + x
+    );
+
+    store_l2(
+      _mm_unpackhi_epi16(b_low, g_low),
+      _mm_unpackhi_epi16(r_low, zero),
+      motion_map_buffer + x + 4
+    );
+
+    store_l2(
+      _mm_unpacklo_epi16(b_high, g_high),
+      _mm_unpacklo_epi16(r_high, zero),
+      motion_map_buffer + x + 8
+    );
+
+    store_l2(
+      _mm_unpackhi_epi16(b_high, g_high),
+      _mm_unpackhi_epi16(r_high, zero),
+      motion_map_buffer + x + 12
+    );
+  }
+
+  return x;
+}
+#endif /* _LABGEN_P_SSSE3_KERNELS_ */
+
+/* ========================================================================== *
+ * ColorDifferenceKernels                                                     *
+ * ========================================================================== */
+
+bool ColorDifferenceKernels::is_supported() {
+#ifdef _LABGEN_P_SSSE3_KERNELS_
+  static const bool supported = __builtin_cpu_supports("ssse3");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+/******************************************************************************/
+
+int ColorDifferenceKernels::difference_l1(
+  const unsigned char* current_buffer,
+  const unsigned char* previous_buffer,
+  int32_t* motion_map_buffer,
+  int cols
+) {
+#ifdef _LABGEN_P_SSSE3_KERNELS_
+  if (is_supported()) {
+    return difference_l1_ssse3(
+      current_buffer,
+      previous_buffer,
+      motion_map_buffer,
+      cols
+    );
+  }
+#endif
+
+  return 0;
+}
+
+/******************************************************************************/
+
+int ColorDifferenceKernels::difference_l2(
+  const unsigned char* current_buffer,
+  const unsigned char* previous_buffer,
+  int32_t* motion_map_buffer,
+  int cols
+) {
+#ifdef _LABGEN_P_SSSE3_KERNELS_
+  if (is_supported()) {
+    return difference_l2_ssse3(
+      current_buffer,
+      previous_buffer,
+      motion_map_buffer,
+      cols
+    );
+  }
+#endif
+
+  return 0;
+}
@@ -0,0 +1,118 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <limits>
+#include <stdexcept>
+
+#include <labgen-p/ConvergenceMonitor.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p::ns_internals;
+
+/* ========================================================================== *
+ * ConvergenceMonitor                                                         *
+ * ========================================================================== */
+
+ConvergenceMonitor::ConvergenceMonitor(
+  size_t pixels,
+  size_t window,
+  double max_changes,
+  double max_motion
+) :
+pixels(pixels),
+window(window),
+max_changes(max_changes),
+max_motion(max_motion),
+frames(0),
+last_check(0),
+window_changes(0),
+changes_ratio(1),
+motion(numeric_limits<double>::infinity()),
+converged(false),
+reference() {
+  if (window == 0)
+    throw logic_error("The stability window must be positive!");
+
+  if ((max_changes < 0) || (max_motion < 0))
+    throw logic_error("The stability thresholds cannot be negative!");
+}
+
+/******************************************************************************/
+
+bool ConvergenceMonitor::update(size_t count, size_t changes) {
+  frames += count;
+  window_changes += changes;
+
+  /* A background is due at the end of each window. */
+  return (frames - last_check) >= window;
+}
+
+/******************************************************************************/
+
+void ConvergenceMonitor::check(Mat& background) {
+  changes_ratio =
+    static_cast<double>(window_changes) / ((frames - last_check) * pixels);
+
+  last_check = frames;
+  window_changes = 0;
+
+  if (!reference.empty()) {
+    motion =
+      norm(background, reference, NORM_L1) /
+      (background.total() * background.channels());
+
+    if ((changes_ratio <= max_changes) && (motion <= max_motion))
+      converged = true;
+  }
+
+  /* The buffer of the previous reference is given back for the next one. */
+  swap(reference, background);
+}
+
+/******************************************************************************/
+
+void ConvergenceMonitor::reset() {
+  frames = 0;
+  last_check = 0;
+  window_changes = 0;
+  changes_ratio = 1;
+  motion = numeric_limits<double>::infinity();
+  converged = false;
+  reference.release();
+}
+
+/******************************************************************************/
+
+bool ConvergenceMonitor::has_converged() const {
+  return converged;
+}
+
+/******************************************************************************/
+
+double ConvergenceMonitor::get_changes_ratio() const {
+  return changes_ratio;
+}
+
+/******************************************************************************/
+
+double ConvergenceMonitor::get_motion() const {
+  return motion;
+}
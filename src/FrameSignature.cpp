@@ -0,0 +1,145 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <labgen-p/FrameSignature.hpp>
+#include <labgen-p/Utils.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+using namespace ns_labgen_p::ns_internals;
+
+/* ========================================================================== *
+ * FrameSignature                                                             *
+ * ========================================================================== */
+
+FrameSignature::FrameSignature() :
+hash(0),
+rows(0),
+cols(0),
+type(-1),
+block_means(),
+column_sums() {}
+
+/******************************************************************************/
+
+void FrameSignature::compute(const Mat& frame) {
+  hash = Utils::hash(frame);
+  rows = frame.rows;
+  cols = frame.cols;
+  type = frame.type();
+
+  if (frame.depth() == CV_16U)
+    compute_means<uint16_t>(frame, 1.f / 257);
+  else
+    compute_means<uint8_t>(frame, 1.f);
+}
+
+/******************************************************************************/
+
+void FrameSignature::clear() {
+  hash = 0;
+  rows = 0;
+  cols = 0;
+  type = -1;
+
+  block_means.clear();
+}
+
+/******************************************************************************/
+
+bool FrameSignature::empty() const {
+  return block_means.empty();
+}
+
+/******************************************************************************/
+
+uint64_t FrameSignature::get_hash() const {
+  return hash;
+}
+
+/******************************************************************************/
+
+double FrameSignature::distance(const FrameSignature& other) const {
+  if (
+    empty()                  ||
+    (rows != other.rows)     ||
+    (cols != other.cols)     ||
+    (type != other.type)
+  ) {
+    return numeric_limits<double>::infinity();
+  }
+
+  float largest = 0;
+
+  for (size_t i = 0; i < block_means.size(); ++i)
+    largest = max(largest, fabs(block_means[i] - other.block_means[i]));
+
+  return largest;
+}
+
+/******************************************************************************/
+
+template <typename Sample>
+void FrameSignature::compute_means(const Mat& frame, float level) {
+  int channels = frame.channels();
+  int samples = frame.cols * channels;
+  int block_rows = (frame.rows + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  int block_cols = (frame.cols + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+  block_means.resize(block_rows * block_cols);
+  column_sums.resize(samples);
+
+  uint32_t* sums_buffer = column_sums.data();
+
+  for (int by = 0; by < block_rows; ++by) {
+    int min_y = by * BLOCK_SIZE;
+    int max_y = min(min_y + BLOCK_SIZE, frame.rows);
+
+    fill(column_sums.begin(), column_sums.end(), 0);
+
+    /* Sums of the samples of each column over the row of blocks. */
+    for (int y = min_y; y < max_y; ++y) {
+      const Sample* buffer = frame.ptr<Sample>(y);
+
+      for (int i = 0; i < samples; ++i)
+        sums_buffer[i] += buffer[i];
+    }
+
+    /* Means of the blocks, border blocks being possibly partial. */
+    float* means_buffer = block_means.data() + (by * block_cols);
+
+    for (int bx = 0; bx < block_cols; ++bx) {
+      int min_i = bx * BLOCK_SIZE * channels;
+      int max_i = min(min_i + (BLOCK_SIZE * channels), samples);
+      uint32_t sum = 0;
+
+      for (int i = min_i; i < max_i; ++i)
+        sum += sums_buffer[i];
+
+      means_buffer[bx] =
+        (level * sum) / ((max_y - min_y) * (max_i - min_i));
+    }
+  }
+}
@@ -18,49 +18,43 @@
  * You should have received a copy of the GNU General Public License
  * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <algorithm>
-#include <cmath>
-#include <cstdlib>
-
-#include <opencv2/imgproc/imgproc.hpp>
-
-#include <labgen-p/FrameDifferenceC1L1.hpp>
+#include <labgen-p/FrameSource.hpp>
+#include <labgen-p/ImageSequenceSource.hpp>
+#include <labgen-p/RawFrameSource.hpp>
+#include <labgen-p/SharedMemorySource.hpp>
+#include <labgen-p/VideoCaptureSource.hpp>
+#include <labgen-p/Y4MSource.hpp>
 
 using namespace std;
 using namespace cv;
-using namespace ns_labgen_p::ns_internals;
+using namespace ns_labgen_p;
 
 /* ========================================================================== *
- * FrameDifferenceC1L1                                                        *
+ * FrameSource                                                                *
  * ========================================================================== */
 
-void FrameDifferenceC1L1::compute(const Mat& current_frame, Mat& motion_map) {
-  if(current_frame.empty())
-    return;
-
-  Mat converted_input;
-
-  if (current_frame.channels() != 1)
-    cvtColor(current_frame, converted_input, CV_BGR2GRAY);
-  else
-    converted_input = current_frame;
+FrameSource::FrameSourcePtr FrameSource::open(
+  const string& input,
+  int reduction,
+  const Size& raw_size,
+  bool native_yuv
+) {
+  if (SharedMemorySource::is_shared_memory(input))
+    return FrameSourcePtr(
+      new SharedMemorySource(input, reduction, native_yuv)
+    );
 
-  if (previous_frame.empty()) {
-    converted_input.copyTo(previous_frame);
-    return;
+  if (raw_size.area() > 0) {
+    return FrameSourcePtr(
+      new RawFrameSource(input, raw_size.height, raw_size.width, reduction)
+    );
   }
 
-  const unsigned char* current_buffer  = converted_input.data;
-  const unsigned char* previous_buffer = previous_frame.data;
-
-  int32_t* motion_map_buffer =
-    reinterpret_cast<int32_t*>(motion_map.data);
+  if ((input == "-") || Y4MSource::is_y4m(input))
+    return FrameSourcePtr(new Y4MSource(input, reduction, native_yuv));
 
-  for (int i = 0; i < current_frame.total(); ++i) {
-    *(motion_map_buffer++) = abs(
-      static_cast<int32_t>(*(current_buffer++)) - *(previous_buffer++)
-    );
-  }
+  if (ImageSequenceSource::is_pattern(input))
+    return FrameSourcePtr(new ImageSequenceSource(input, reduction));
 
-  converted_input.copyTo(previous_frame);
+  return FrameSourcePtr(new VideoCaptureSource(input, reduction));
 }
@@ -19,6 +19,7 @@
  * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <algorithm>
+#include <cmath>
 #include <stdexcept>
 
 #include <boost/lexical_cast.hpp>
@@ -30,6 +31,83 @@ using namespace boost;
 using namespace cv;
 using namespace ns_labgen_p;
 
+/* ========================================================================== *
+ * GridWindow::TileSampler                                                    *
+ * ========================================================================== */
+
+/**
+ * Resizes an 8-bit matrix into a BGR tile with the sampling tables of the
+ * tile, expanding gray matrices and dropping the alpha channel on the fly.
+ */
+class GridWindow::TileSampler : public ParallelLoopBody {
+  private :
+
+    const Mat& mat;
+    Mat& roi;
+    const Tile& tile;
+
+  public :
+
+    TileSampler(const Mat& mat, Mat& roi, const Tile& tile) :
+    mat(mat), roi(roi), tile(tile) {}
+
+    void operator()(const Range& range) const {
+      const bool gray = (mat.channels() == 1);
+
+      for (int32_t row = range.start; row < range.end; ++row) {
+        const uint8_t* top = mat.ptr<uint8_t>(tile.y_offsets[2 * row]);
+        const uint8_t* bottom = mat.ptr<uint8_t>(tile.y_offsets[2 * row + 1]);
+        const int32_t y_weight = tile.y_weights[row];
+        uint8_t* out = roi.ptr<uint8_t>(row);
+
+        for (int32_t col = 0; col < roi.cols; ++col, out += 3) {
+          const int32_t left = tile.x_offsets[2 * col];
+          const int32_t right = tile.x_offsets[2 * col + 1];
+          const int32_t x_weight = tile.x_weights[col];
+
+          /* A gray value is computed once and replicated. */
+          if (gray) {
+            out[0] = out[1] = out[2] = interpolate(
+              top + left, top + right, bottom + left, bottom + right,
+              x_weight, y_weight
+            );
+          }
+          else {
+            for (int32_t channel = 0; channel < 3; ++channel) {
+              out[channel] = interpolate(
+                top + left + channel, top + right + channel,
+                bottom + left + channel, bottom + right + channel,
+                x_weight, y_weight
+              );
+            }
+          }
+        }
+      }
+    }
+
+  private :
+
+    static inline uint8_t interpolate(
+      const uint8_t* top_left,
+      const uint8_t* top_right,
+      const uint8_t* bottom_left,
+      const uint8_t* bottom_right,
+      int32_t x_weight,
+      int32_t y_weight
+    ) {
+      const int32_t one = 1 << WEIGHT_BITS;
+
+      int32_t top = *top_left * (one - x_weight) + *top_right * x_weight;
+      int32_t bottom =
+        *bottom_left * (one - x_weight) + *bottom_right * x_weight;
+
+      return static_cast<uint8_t>(
+        (top * (one - y_weight) + bottom * y_weight +
+         (1 << (2 * WEIGHT_BITS - 1))) >> (2 * WEIGHT_BITS)
+      );
+    }
+};
+
 /* ========================================================================== *
  * GridWindow                                                                 *
  * ========================================================================== */
@@ -57,7 +135,8 @@ rows(rows),
 cols(cols),
 interpolation(Interpolation::LINEAR),
 k_ratio(false),
-title_properties(titles_properties) {
+title_properties(titles_properties),
+modified(true) {
   if (height <= 0)
     throw logic_error("The height must be larger than 0");
 
@@ -104,6 +183,9 @@ title_properties(titles_properties) {
       }
     }
   }
+
+  tiles.resize(rois.size());
+  invalidate();
 }
 
 /******************************************************************************/
@@ -113,7 +195,7 @@ GridWindow::~GridWindow() {
 }
 
 /******************************************************************************/
-#include <iostream>
+
 void GridWindow::display(const Mat& mat, int32_t index) {
   if ((index < 0) || (index >= rois.size())) {
     throw logic_error(
@@ -121,50 +203,45 @@ void GridWindow::display(const Mat& mat, int32_t index) {
     );
   }
 
-  Mat roi = buffer(rois[index]);
-
-  /* Rendering. */
-  if ((mat.rows != roi.rows) || (mat.cols != roi.cols)) {
-    /* Adapt roi to keep aspect ratio. */
-    if (k_ratio) {
-      double ratio = min(
-        static_cast<double>(roi.rows) / mat.rows,
-        static_cast<double>(roi.cols) / mat.cols
-      );
+  render(mat, index);
+  tiles[index].rendered = false;
+}
 
-      int32_t resize_height = mat.rows * ratio;
-      int32_t resize_width = mat.cols * ratio;
+/******************************************************************************/
 
-      Rect rect = rois[index];
-      rect.y = rect.y + (rect.height - resize_height) / 2;
-      rect.x = rect.x + (rect.width - resize_width) / 2;
-      rect.height = resize_height;
-      rect.width = resize_width;
+void GridWindow::display_if_changed(
+  const Mat& mat,
+  int32_t index,
+  uint64_t revision
+) {
+  if ((index < 0) || (index >= rois.size())) {
+    throw logic_error(
+      "The index " + lexical_cast<string>(index) + " is out of bounds"
+    );
+  }
 
-      roi = buffer(rect);
-    }
+  Tile& tile = tiles[index];
 
-    /* Resize mat directly in roi. */
-    if (mat.type() == CV_8UC3)
-      resize(mat, roi, Size(roi.cols, roi.rows), 0, 0, interpolation);
-    else { // Convert to color.
-      Mat resized;
-      resize(mat, resized, Size(roi.cols, roi.rows), 0, 0, interpolation);
-      cvtColor(resized, roi, CV_GRAY2BGR);
-    }
-  }
-  else {
-    if (mat.type() == CV_8UC3)
-      mat.copyTo(roi);
-    else // Convert to color.
-      cvtColor(mat, roi, CV_GRAY2BGR);
+  /* The tile already shows this revision of the matrix. */
+  if (
+    tile.rendered                    &&
+    (tile.revision == revision)      &&
+    (tile.source_size == mat.size()) &&
+    (tile.source_type == mat.type())
+  ) {
+    return;
   }
+
+  render(mat, index);
+
+  tile.revision = revision;
+  tile.rendered = true;
 }
 
 /******************************************************************************/
 
 void GridWindow::display(const Mat& mat, int32_t row, int32_t col) {
-  display(mat, width * row + col);
+  display(mat, cols * row + col);
 }
 
 /******************************************************************************/
@@ -182,6 +259,7 @@ void GridWindow::put_title(const string& title, int32_t index) {
     return;
 
   title_cache[index] = title;
+  modified = true;
 
   /* Extracting the appropriate ROI from the buffer. */
   Mat title_roi = buffer(title_rois[index]);
@@ -236,13 +314,18 @@ void GridWindow::put_title(const string& title, int32_t index) {
 /******************************************************************************/
 
 void GridWindow::put_title(const string& title, int32_t row, int32_t col) {
-  put_title(title, width * row + col);
+  put_title(title, cols * row + col);
 }
 
 /******************************************************************************/
 
 void GridWindow::refresh() {
+  /* HighGUI keeps its own copy of the last image shown. */
+  if (!modified)
+    return;
+
   imshow(window_name, buffer);
+  modified = false;
 }
 
 /******************************************************************************/
@@ -255,12 +338,14 @@ bool GridWindow::are_titles_enabled() const {
 
 void GridWindow::keep_ratio() {
   k_ratio = true;
+  invalidate();
 }
 
 /******************************************************************************/
 
 void GridWindow::ignore_ratio() {
   k_ratio = false;
+  invalidate();
 }
 
 /******************************************************************************/
@@ -285,4 +370,168 @@ GridWindow::Interpolation GridWindow::get_interpolation_algorithm() const {
 
 void GridWindow::set_interpolation_algorithm(Interpolation algorithm) {
   interpolation = algorithm;
+  invalidate();
+}
+
+/******************************************************************************/
+
+void GridWindow::render(const Mat& mat, int32_t index) {
+  Tile& tile = tiles[index];
+
+  if ((tile.source_size != mat.size()) || (tile.source_type != mat.type()))
+    prepare(tile, mat, index);
+
+  Mat roi = buffer(tile.rect);
+  modified = true;
+
+  /* Rendering. */
+  if ((mat.rows == roi.rows) && (mat.cols == roi.cols)) {
+    if (mat.type() == CV_8UC3)
+      mat.copyTo(roi);
+    else // Convert to color.
+      cvtColor(mat, roi, (mat.channels() == 4) ? CV_BGRA2BGR : CV_GRAY2BGR);
+  }
+  else if (!tile.x_offsets.empty())
+    parallel_for_(Range(0, roi.rows), TileSampler(mat, roi, tile));
+  else {
+    /* Resize mat directly in roi. */
+    if (mat.type() == CV_8UC3)
+      resize(mat, roi, Size(roi.cols, roi.rows), 0, 0, interpolation);
+    else { // Convert to color.
+      Mat resized;
+      resize(mat, resized, Size(roi.cols, roi.rows), 0, 0, interpolation);
+      cvtColor(
+        resized,
+        roi,
+        (resized.channels() == 4) ? CV_BGRA2BGR : CV_GRAY2BGR
+      );
+    }
+  }
+}
+
+/******************************************************************************/
+
+void GridWindow::prepare(Tile& tile, const Mat& mat, int32_t index) {
+  tile.source_size = mat.size();
+  tile.source_type = mat.type();
+  tile.rendered = false;
+
+  Rect rect = rois[index];
+
+  /* Adapt roi to keep aspect ratio. */
+  if (k_ratio && ((mat.rows != rect.height) || (mat.cols != rect.width))) {
+    double ratio = min(
+      static_cast<double>(rect.height) / mat.rows,
+      static_cast<double>(rect.width) / mat.cols
+    );
+
+    int32_t resize_height = mat.rows * ratio;
+    int32_t resize_width = mat.cols * ratio;
+
+    rect.y = rect.y + (rect.height - resize_height) / 2;
+    rect.x = rect.x + (rect.width - resize_width) / 2;
+    rect.height = resize_height;
+    rect.width = resize_width;
+  }
+
+  /* The margins left by a smaller rect are cleared once. */
+  if (rect != tile.rect) {
+    buffer(rois[index]) = Scalar::all(0);
+    tile.rect = rect;
+  }
+
+  tile.x_offsets.clear();
+  tile.x_weights.clear();
+  tile.y_offsets.clear();
+  tile.y_weights.clear();
+
+  /* The sampling tables are used for 8-bit matrices with the two simplest
+   * interpolations, the other cases being handled by resize.
+   */
+  bool sampled =
+    (mat.depth() == CV_8U)                                           &&
+    ((mat.channels() == 1) || (mat.channels() == 3) ||
+     (mat.channels() == 4))                                          &&
+    ((interpolation == Interpolation::NEAREST) ||
+     (interpolation == Interpolation::LINEAR))                       &&
+    ((mat.rows != rect.height) || (mat.cols != rect.width));
+
+  if (sampled) {
+    compute_sampling_table(
+      mat.cols,
+      rect.width,
+      mat.channels(),
+      interpolation,
+      tile.x_offsets,
+      tile.x_weights
+    );
+
+    compute_sampling_table(
+      mat.rows,
+      rect.height,
+      1,
+      interpolation,
+      tile.y_offsets,
+      tile.y_weights
+    );
+  }
+}
+
+/******************************************************************************/
+
+void GridWindow::invalidate() {
+  for (Tile& tile : tiles) {
+    tile.source_size = Size();
+    tile.source_type = -1;
+    tile.rendered = false;
+  }
+}
+
+/******************************************************************************/
+
+void GridWindow::compute_sampling_table(
+  int32_t source_length,
+  int32_t length,
+  int32_t step,
+  Interpolation interpolation,
+  vector<int32_t>& offsets,
+  vector<int32_t>& weights
+) {
+  offsets.resize(2 * length);
+  weights.resize(length);
+
+  double scale = static_cast<double>(source_length) / length;
+
+  for (int32_t i = 0; i < length; ++i) {
+    int32_t first;
+    int32_t second;
+    double weight = 0;
+
+    /* Same coordinates as resize. */
+    if (interpolation == Interpolation::NEAREST) {
+      first = min(static_cast<int32_t>(floor(i * scale)), source_length - 1);
+      second = first;
+    }
+    else {
+      double position = (i + 0.5) * scale - 0.5;
+      first = static_cast<int32_t>(floor(position));
+      weight = position - first;
+
+      if (first < 0) {
+        first = 0;
+        weight = 0;
+      }
+
+      if (first >= source_length - 1) {
+        first = source_length - 1;
+        weight = 0;
+      }
+
+      second = min(first + 1, source_length - 1);
+    }
+
+    offsets[2 * i] = first * step;
+    offsets[2 * i + 1] = second * step;
+    weights[i] = cvRound(weight * (1 << WEIGHT_BITS));
+  }
 }
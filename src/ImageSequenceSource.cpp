@@ -0,0 +1,369 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <labgen-p/ImageSequenceSource.hpp>
+#include <labgen-p/Utils.hpp>
+
+/* Reduced decoding modes of imread, available since OpenCV 3.2. OpenCV 2.4
+ * defines CV_VERSION_MAJOR as 4 too, hence the check of OPENCV_VERSION first.
+ */
+#if (OPENCV_VERSION >= 3) && (                                                 \
+      (CV_VERSION_MAJOR > 3) ||                                                \
+      ((CV_VERSION_MAJOR == 3) && (CV_VERSION_MINOR >= 2))                     \
+    )
+#define _LABGEN_P_IMREAD_REDUCED_
+#endif
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+
+/* ========================================================================== *
+ * ImageSequenceSource                                                        *
+ * ========================================================================== */
+
+ImageSequenceSource::ImageSequenceSource(
+  const string& pattern,
+  int reduction,
+  size_t threads
+) :
+pattern(pattern),
+reduction(reduction),
+window(0),
+first_index(0),
+frames_count(0),
+height(0),
+width(0),
+format(PixelFormat::BGR24),
+next_decode(0),
+next_read(0),
+last_index(~static_cast<size_t>(0)),
+sequential_reads(0),
+stopped(false) {
+  if (!is_pattern(pattern))
+    throw logic_error("The pattern '" + pattern + "' is not valid");
+
+  if (
+    (reduction != 1) && (reduction != 2) &&
+    (reduction != 4) && (reduction != 8)
+  ) {
+    throw logic_error("The reduction factor must be 1, 2, 4 or 8");
+  }
+
+  if (threads == 0)
+    threads = max(thread::hardware_concurrency(), 1u);
+
+  window = 2 * threads;
+  sequential_reads = window;
+
+  /* The first image gives the size and the format of the sequence. */
+  for (; first_index <= 1; ++first_index) {
+    Mat first_frame = imread(get_path(first_index), IMREAD_UNCHANGED);
+
+    if (first_frame.empty())
+      continue;
+
+    if (first_frame.type() == CV_8UC1)
+      format = PixelFormat::GRAY8;
+    else if (first_frame.type() == CV_16UC1)
+      format = PixelFormat::GRAY16;
+
+    first_frame = load(first_index);
+
+    if (!first_frame.empty()) {
+      height = first_frame.rows;
+      width  = first_frame.cols;
+
+      reorder_buffer[first_index] = first_frame;
+      next_read   = first_index;
+      next_decode = first_index + 1;
+
+      break;
+    }
+  }
+
+  if (reorder_buffer.empty())
+    throw runtime_error("Cannot open the '" + pattern + "' sequence.");
+
+  for (size_t i = 0; i < threads; ++i)
+    workers.push_back(thread(&ImageSequenceSource::decode, this));
+}
+
+/******************************************************************************/
+
+ImageSequenceSource::~ImageSequenceSource() {
+  {
+    lock_guard<std::mutex> lock(mutex);
+    stopped = true;
+  }
+
+  consumed.notify_all();
+
+  for (thread& worker : workers)
+    worker.join();
+}
+
+/******************************************************************************/
+
+bool ImageSequenceSource::read(Mat& frame) {
+  unique_lock<std::mutex> lock(mutex);
+
+  decoded.wait(lock, [this] {
+    return
+      (next_read >= last_index) ||
+      (reorder_buffer.find(next_read) != reorder_buffer.end());
+  });
+
+  if (next_read >= last_index)
+    return false;
+
+  ReorderBuffer::iterator it = reorder_buffer.find(next_read);
+  frame = it->second;
+
+  reorder_buffer.erase(it);
+  ++next_read;
+  ++sequential_reads;
+  lock.unlock();
+
+  consumed.notify_all();
+  return true;
+}
+
+/******************************************************************************/
+
+int32_t ImageSequenceSource::get_height() const {
+  return height;
+}
+
+/******************************************************************************/
+
+int32_t ImageSequenceSource::get_width() const {
+  return width;
+}
+
+/******************************************************************************/
+
+PixelFormat ImageSequenceSource::get_pixel_format() const {
+  return format;
+}
+
+/******************************************************************************/
+
+bool ImageSequenceSource::is_seekable() const {
+  return true;
+}
+
+/******************************************************************************/
+
+size_t ImageSequenceSource::get_frames_count() const {
+  /* The images are counted without being decoded, up to the first missing
+   * one.
+   */
+  if (frames_count == 0) {
+    for (;;) {
+      FILE* image = fopen(get_path(first_index + frames_count).c_str(), "rb");
+
+      if (image == nullptr)
+        break;
+
+      fclose(image);
+      ++frames_count;
+    }
+  }
+
+  return frames_count;
+}
+
+/******************************************************************************/
+
+void ImageSequenceSource::seek(size_t index) {
+  {
+    lock_guard<std::mutex> lock(mutex);
+
+    if (first_index + index == next_read)
+      return;
+
+    next_read = first_index + index;
+    next_decode = next_read;
+    sequential_reads = 0;
+
+    /* The images already decoded in the new window are kept. */
+    ReorderBuffer::iterator it = reorder_buffer.begin();
+
+    while (it != reorder_buffer.end()) {
+      if ((it->first < next_read) || (it->first >= next_read + window))
+        it = reorder_buffer.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  consumed.notify_all();
+}
+
+/******************************************************************************/
+
+bool ImageSequenceSource::is_pattern(const string& input) {
+  size_t begin = input.find('%');
+
+  if (begin == string::npos)
+    return false;
+
+  /* Exactly one conversion, of the %d or %0Nd kind. */
+  size_t end = input.find_first_not_of("0123456789", begin + 1);
+
+  return
+    (end != string::npos) &&
+    (input[end] == 'd') &&
+    (input.find('%', end) == string::npos);
+}
+
+/******************************************************************************/
+
+string ImageSequenceSource::get_path(size_t index) const {
+  vector<char> path(pattern.size() + 32);
+  snprintf(path.data(), path.size(), pattern.c_str(), static_cast<int>(index));
+
+  return string(path.data());
+}
+
+/******************************************************************************/
+
+Mat ImageSequenceSource::load(size_t index) const {
+  Mat frame;
+  bool reduced = false;
+
+#ifdef _LABGEN_P_IMREAD_REDUCED_
+  /* The reduced decoding modes only give 8-bit images. */
+  if ((reduction > 1) && (format != PixelFormat::GRAY16)) {
+    bool gray = (format == PixelFormat::GRAY8);
+    int flags = gray ? IMREAD_REDUCED_GRAYSCALE_2 : IMREAD_REDUCED_COLOR_2;
+
+    if (reduction == 4)
+      flags = gray ? IMREAD_REDUCED_GRAYSCALE_4 : IMREAD_REDUCED_COLOR_4;
+    else if (reduction == 8)
+      flags = gray ? IMREAD_REDUCED_GRAYSCALE_8 : IMREAD_REDUCED_COLOR_8;
+
+    frame = imread(get_path(index), flags);
+    reduced = true;
+  }
+#endif
+
+  if (!reduced) {
+    frame = imread(
+      get_path(index),
+      (format == PixelFormat::BGR24) ?
+        IMREAD_COLOR : (IMREAD_GRAYSCALE | IMREAD_ANYDEPTH)
+    );
+  }
+
+  if (frame.empty())
+    return frame;
+
+  /* The gray images take the depth of the first one. */
+  if ((format == PixelFormat::GRAY8) && (frame.depth() == CV_16U))
+    Utils::reduce_depth(frame, frame);
+  else if ((format == PixelFormat::GRAY16) && (frame.depth() == CV_8U))
+    frame.convertTo(frame, CV_16U, 257);
+
+  if (reduction == 1)
+    return frame;
+
+  Size reduced_size = frame.size();
+
+  if (!reduced) {
+    reduced_size = Size(
+      Utils::scaled_size(frame.cols, reduction),
+      Utils::scaled_size(frame.rows, reduction)
+    );
+  }
+
+  /* The first image gives the size of the sequence, which is enforced for the
+   * next ones as the decoders do not agree on rounding.
+   */
+  Size size = (height > 0) ? Size(width, height) : reduced_size;
+
+  if (frame.size() != size) {
+    Mat resized;
+    resize(frame, resized, size, 0, 0, INTER_AREA);
+
+    return resized;
+  }
+
+  return frame;
+}
+
+/******************************************************************************/
+
+size_t ImageSequenceSource::get_readahead() const {
+  /* At least the two images of a pair of frames. */
+  return min(window, max(sequential_reads, static_cast<size_t>(2)));
+}
+
+/******************************************************************************/
+
+void ImageSequenceSource::decode() {
+  for (;;) {
+    size_t index;
+
+    {
+      unique_lock<std::mutex> lock(mutex);
+
+      /* The decoding cannot go further than the readahead after the next
+       * image to read, and skips the images kept by a seek.
+       */
+      consumed.wait(lock, [this] {
+        while (reorder_buffer.find(next_decode) != reorder_buffer.end())
+          ++next_decode;
+
+        return
+          stopped ||
+          (next_decode >= last_index) ||
+          (next_decode < next_read + get_readahead());
+      });
+
+      if (stopped || (next_decode >= last_index))
+        return;
+
+      index = next_decode++;
+    }
+
+    Mat frame = load(index);
+
+    {
+      lock_guard<std::mutex> lock(mutex);
+
+      /* An image decoded before a seek may not be needed anymore. */
+      if (frame.empty())
+        last_index = min(last_index, index);
+      else if ((index < last_index) && (index >= next_read))
+        reorder_buffer[index] = frame;
+    }
+
+    decoded.notify_all();
+  }
+}
@@ -0,0 +1,350 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <labgen-p/JobProtocol.hpp>
+
+/* Without MSG_NOSIGNAL, the process must ignore SIGPIPE. */
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+using namespace std;
+using namespace boost;
+using namespace ns_labgen_p;
+
+/* ========================================================================== *
+ * JobProtocol                                                                *
+ * ========================================================================== */
+
+int JobProtocol::listen(const string& path) {
+  sockaddr_un address;
+  get_address(path, address);
+
+  /* A socket left by a stopped daemon is replaced, but neither another kind
+   * of file nor the socket of a running daemon, which accepts connections.
+   */
+  struct stat status;
+
+  if (lstat(path.c_str(), &status) == 0) {
+    if (!S_ISSOCK(status.st_mode))
+      throw runtime_error("The file '" + path + "' is not a socket.");
+
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool refused =
+      (probe >= 0) &&
+      (
+        ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address))
+        < 0
+      ) &&
+      (errno == ECONNREFUSED);
+
+    if (probe >= 0)
+      close(probe);
+
+    if (!refused)
+      throw runtime_error("The socket '" + path + "' is in use.");
+
+    unlink(path.c_str());
+  }
+
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (server < 0)
+    throw runtime_error("Cannot create the socket '" + path + "'.");
+
+  if (
+    (bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+    || (::listen(server, SOMAXCONN) < 0)
+  ) {
+    close(server);
+    throw runtime_error("Cannot listen on the socket '" + path + "'.");
+  }
+
+  return server;
+}
+
+/******************************************************************************/
+
+int JobProtocol::connect(const string& path) {
+  sockaddr_un address;
+  get_address(path, address);
+
+  int client = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (client < 0)
+    throw runtime_error("Cannot create a socket.");
+
+  if (
+    ::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address))
+    < 0
+  ) {
+    close(client);
+    throw runtime_error("Cannot connect to the socket '" + path + "'.");
+  }
+
+  return client;
+}
+
+/******************************************************************************/
+
+bool JobProtocol::read(int socket, Message& message) {
+  uint32_t size;
+  ssize_t received;
+
+  /* A connection closed before a new message is not an error. */
+  do {
+    received = recv(socket, &size, 1, MSG_PEEK);
+  } while ((received < 0) && (errno == EINTR));
+
+  if (received == 0)
+    return false;
+
+  read_bytes(socket, reinterpret_cast<char*>(&size), sizeof(size));
+  size = ntohl(size);
+
+  if (size > MAX_MESSAGE_SIZE)
+    throw runtime_error("The message is too large.");
+
+  string payload(size, '\0');
+  read_bytes(socket, &payload[0], size);
+  parse(payload, message);
+
+  return true;
+}
+
+/******************************************************************************/
+
+void JobProtocol::write(int socket, const Message& message) {
+  string payload;
+
+  for (const Message::value_type& field : message) {
+    if (
+      (field.first.find_first_of("=\n") != string::npos) ||
+      (field.second.find('\n') != string::npos)
+    ) {
+      throw logic_error("The field '" + field.first + "' cannot be sent.");
+    }
+
+    payload += field.first + "=" + field.second + "\n";
+  }
+
+  if (payload.size() > MAX_MESSAGE_SIZE)
+    throw logic_error("The message is too large.");
+
+  uint32_t size = htonl(static_cast<uint32_t>(payload.size()));
+
+  write_bytes(socket, reinterpret_cast<const char*>(&size), sizeof(size));
+  write_bytes(socket, payload.data(), payload.size());
+}
+
+/******************************************************************************/
+
+bool JobProtocol::extract(string& received, Message& message) {
+  uint32_t size;
+
+  if (received.size() < sizeof(size))
+    return false;
+
+  memcpy(&size, received.data(), sizeof(size));
+  size = ntohl(size);
+
+  if (size > MAX_MESSAGE_SIZE)
+    throw runtime_error("The message is too large.");
+
+  if (received.size() < sizeof(size) + size)
+    return false;
+
+  parse(received.substr(sizeof(size), size), message);
+  received.erase(0, sizeof(size) + size);
+
+  return true;
+}
+
+/******************************************************************************/
+
+JobProtocol::Message JobProtocol::encode_job(
+  const BatchRunner::Job& job,
+  int32_t priority
+) {
+  Message message;
+
+  message["input"] = job.input;
+  message["output"] = job.output;
+  message["s"] = lexical_cast<string>(job.s);
+  message["n"] = lexical_cast<string>(job.n);
+  message["motion_scale"] = lexical_cast<string>(job.motion_scale);
+  message["priority"] = lexical_cast<string>(priority);
+
+  return message;
+}
+
+/******************************************************************************/
+
+BatchRunner::Job JobProtocol::decode_job(
+  const Message& message,
+  int32_t& priority
+) {
+  BatchRunner::Job job;
+
+  try {
+    job.input = get(message, "input");
+    job.output = get(message, "output");
+    job.s = lexical_cast<int32_t>(get(message, "s"));
+    job.n = lexical_cast<int32_t>(get(message, "n"));
+    job.motion_scale = lexical_cast<int32_t>(get(message, "motion_scale"));
+    priority = lexical_cast<int32_t>(get(message, "priority"));
+  }
+  catch (const bad_lexical_cast&) {
+    throw runtime_error("The job request holds an invalid number.");
+  }
+
+  return job;
+}
+
+/******************************************************************************/
+
+JobProtocol::Message JobProtocol::encode_result(
+  const BatchRunner::Result& result
+) {
+  Message message;
+
+  message["status"] = result.success ? "ok" : "error";
+  message["message"] = result.message;
+  message["frames"] = lexical_cast<string>(result.frames);
+  message["queued_ms"] =
+    lexical_cast<string>(static_cast<int64_t>(result.queued_seconds * 1000));
+  message["processing_ms"] = lexical_cast<string>(
+    static_cast<int64_t>(result.processing_seconds * 1000)
+  );
+
+  /* The message of an exception may span several lines. */
+  replace(message["message"].begin(), message["message"].end(), '\n', ' ');
+
+  return message;
+}
+
+/******************************************************************************/
+
+BatchRunner::Result JobProtocol::decode_result(const Message& message) {
+  BatchRunner::Result result;
+
+  try {
+    result.success = (get(message, "status") == "ok");
+    result.message = get(message, "message");
+    result.frames = lexical_cast<size_t>(get(message, "frames"));
+    result.queued_seconds =
+      lexical_cast<int64_t>(get(message, "queued_ms")) / 1000.;
+    result.processing_seconds =
+      lexical_cast<int64_t>(get(message, "processing_ms")) / 1000.;
+  }
+  catch (const bad_lexical_cast&) {
+    throw runtime_error("The job result holds an invalid number.");
+  }
+
+  return result;
+}
+
+/******************************************************************************/
+
+void JobProtocol::parse(const string& payload, Message& message) {
+  message.clear();
+  istringstream lines(payload);
+  string line;
+
+  while (getline(lines, line)) {
+    size_t separator = line.find('=');
+
+    if (separator == string::npos)
+      throw runtime_error("The message is malformed.");
+
+    message[line.substr(0, separator)] = line.substr(separator + 1);
+  }
+}
+
+/******************************************************************************/
+
+void JobProtocol::read_bytes(int socket, char* buffer, size_t size) {
+  while (size > 0) {
+    ssize_t received = recv(socket, buffer, size, 0);
+
+    if (received < 0 && errno == EINTR)
+      continue;
+
+    if (received <= 0)
+      throw runtime_error("The connection has been interrupted.");
+
+    buffer += received;
+    size -= received;
+  }
+}
+
+/******************************************************************************/
+
+void JobProtocol::write_bytes(int socket, const char* buffer, size_t size) {
+  while (size > 0) {
+    ssize_t sent = send(socket, buffer, size, MSG_NOSIGNAL);
+
+    if (sent < 0 && errno == EINTR)
+      continue;
+
+    if (sent <= 0)
+      throw runtime_error("The connection has been interrupted.");
+
+    buffer += sent;
+    size -= sent;
+  }
+}
+
+/******************************************************************************/
+
+void JobProtocol::get_address(const string& path, sockaddr_un& address) {
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+
+  if (path.size() >= sizeof(address.sun_path))
+    throw logic_error("The socket path '" + path + "' is too long.");
+
+  strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+}
+
+/******************************************************************************/
+
+const string& JobProtocol::get(const Message& message, const string& key) {
+  Message::const_iterator field = message.find(key);
+
+  if (field == message.end())
+    throw runtime_error("The field '" + key + "' is missing.");
+
+  return field->second;
+}
@@ -19,9 +19,14 @@
  * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <algorithm>
+#include <memory>
 #include <stdexcept>
+#include <utility>
 
+#include <labgen-p/ApproximateHistory.hpp>
+#include <labgen-p/History.hpp>
 #include <labgen-p/LaBGen_P.hpp>
+#include <labgen-p/SubsampledHistory.hpp>
 #include <labgen-p/Utils.hpp>
 
 using namespace std;
@@ -33,49 +38,579 @@ using namespace ns_labgen_p::ns_internals;
  * LaBGen_P                                                                   *
  * ========================================================================== */
 
-LaBGen_P::LaBGen_P(size_t height, size_t width, int32_t s, int32_t n) :
+LaBGen_P::LaBGen_P(
+  size_t height,
+  size_t width,
+  int32_t s,
+  int32_t n,
+  int32_t motion_scale
+) :
 height(height),
 width(width),
 s(s),
 n(n),
-motion_map(height, width, CV_32SC1),
-filter((min(height, width) / n) | 1),
-history(Utils::getROIs(height, width), s),
-first_frame(true) {
-  quantities_of_motion = Mat(height, width, filter.getOpenCVEncoding());
+motion_scale(motion_scale),
+detector(DETECTOR_C1L1),
+allocated_detector(DETECTOR_C1L1),
+motion_detector(),
+motion_map(
+  Utils::scaled_size(height, motion_scale),
+  Utils::scaled_size(width, motion_scale),
+  CV_32SC1,
+  Scalar(0)
+),
+filter((min(motion_map.rows, motion_map.cols) / n) | 1),
+motion_thresholding(false),
+t_diff(motion_scale),
+motion_mask(),
+mask_filter((min(motion_map.rows, motion_map.cols) / n) | 1),
+duplicates_skipping(false),
+duplicate_tolerance(0),
+signature(),
+reference_signature(),
+previous_hash(0),
+reusable_quantities(false),
+skipped_frames(0),
+reused_frames(0),
+history(),
+chroma_subsampling(false),
+median_approximation(false),
+first_frame(true),
+color_space(COLOR_SPACE_NONE),
+history_color_space(COLOR_SPACE_NONE),
+inserted_frames(0),
+publication_period(0),
+last_publication(0),
+epoch(0),
+snapshot_pool(make_shared<SnapshotPool>()),
+changed_pixels(0),
+monitor(),
+converged(false) {
+  quantities_of_motion =
+    Mat(motion_map.rows, motion_map.cols, filter.getOpenCVEncoding());
+}
+
+/******************************************************************************/
+
+void LaBGen_P::subsample_chroma() {
+  if (history != nullptr) {
+    throw logic_error(
+      "The chroma subsampling must be enabled before inserting frames"
+    );
+  }
+
+  /* Only the histories of 4:2:0 frames are subsampled. */
+  chroma_subsampling = true;
+}
+
+/******************************************************************************/
+
+void LaBGen_P::approximate_median() {
+  if (history != nullptr) {
+    throw logic_error(
+      "The median approximation must be enabled before inserting frames"
+    );
+  }
+
+  /* Replaces the full history, chroma subsampling included. */
+  median_approximation = true;
+}
+
+/******************************************************************************/
+
+void LaBGen_P::threshold_motion(uint8_t threshold) {
+  if (!first_frame) {
+    throw logic_error(
+      "The motion must be thresholded before inserting frames"
+    );
+  }
+
+  /* The thresholded difference is computed on the luma only. */
+  if (detector != DETECTOR_C1L1)
+    throw logic_error("The motion threshold requires the C1L1 detector");
+
+  /* The motion map is then left as is, the motion mask replacing it. */
+  motion_thresholding = true;
+  t_diff.set_threshold(threshold);
+}
+
+/******************************************************************************/
+
+void LaBGen_P::use_detector(Detector detector) {
+  if (!first_frame) {
+    throw logic_error(
+      "The motion detector must be chosen before inserting frames"
+    );
+  }
+
+  if (motion_thresholding && (detector != DETECTOR_C1L1))
+    throw logic_error("The motion threshold requires the C1L1 detector");
+
+  this->detector = detector;
+}
+
+/******************************************************************************/
+
+void LaBGen_P::skip_duplicates(double tolerance) {
+  if (!first_frame) {
+    throw logic_error(
+      "The duplicates must be skipped before inserting frames"
+    );
+  }
+
+  if (tolerance < 0)
+    throw logic_error("The tolerance of the near duplicates is negative");
+
+  /* Only the frames inserted alone are compared, not the batches nor the
+   * pairs.
+   */
+  duplicates_skipping = true;
+  duplicate_tolerance = tolerance;
+}
+
+/******************************************************************************/
+
+void LaBGen_P::reset() {
+  /* The history and the buffers are kept for the next sequence, which can
+   * have another color space as long as it has the same dimensions.
+   */
+  if (history != nullptr)
+    history->clear();
+
+  if (motion_detector != nullptr)
+    motion_detector->reset();
+
+  t_diff.reset();
+  reference_signature.clear();
+  reusable_quantities = false;
+  skipped_frames = 0;
+  reused_frames = 0;
+  first_frame = true;
+  color_space = COLOR_SPACE_NONE;
+
+  inserted_frames = 0;
+  last_publication = 0;
+
+  /* Released out of the lock, as the deleter could take the pool one. */
+  BackgroundSnapshotPtr previous;
+
+  {
+    lock_guard<mutex> lock(publication_mutex);
+    previous.swap(published_snapshot);
+  }
+
+  changed_pixels = 0;
+  converged = false;
+
+  if (monitor != nullptr)
+    monitor->reset();
+}
+
+/******************************************************************************/
+
+void LaBGen_P::allocate_history(PixelFormat format) {
+  /* Otherwise allocated by the first insertion, which then fixes the color
+   * space. The color space stays free until then.
+   */
+  fix_color_space(format);
+  color_space = COLOR_SPACE_NONE;
 }
 
 /******************************************************************************/
 
 void LaBGen_P::insert(const Mat& current_frame) {
-  /* Motion map computation by frame difference. */
-  f_diff.compute(current_frame, motion_map);
+  insert(current_frame, get_pixel_format(current_frame));
+}
+
+/******************************************************************************/
+
+void LaBGen_P::insert(const Mat& current_frame, PixelFormat format) {
+  check_frame(current_frame, format);
+  fix_color_space(format);
+
+  /* A duplicate of the previous frame is skipped, and a near duplicate keeps
+   * the quantities of motion of the last frame whose motion was computed.
+   */
+  Repetition repetition = check_repetition(current_frame);
+
+  if (repetition == REPETITION_EXACT)
+    return;
+
+  if (repetition == REPETITION_NONE) {
+    /* Motion map computation by frame difference. */
+    compute_difference(current_frame, format, motion_map);
+
+    /* Initialization of background subtraction. */
+    if (first_frame) {
+      first_frame = false;
+      return;
+    }
+
+    /* Filtering motion map to produce quantities of motion. */
+    compute_quantities(motion_map, quantities_of_motion);
+  }
+
+  /* Insert the current frame along with the quantities of motion into the
+   * history.
+   */
+  size_t changes =
+    history->insert(quantities_of_motion, current_frame, format);
+
+  if (motion_callback)
+    motion_callback(quantities_of_motion);
+
+  count_inserted_frames(1, changes);
+}
+
+/******************************************************************************/
+
+void LaBGen_P::insert(const uint8_t* data, size_t stride, PixelFormat format) {
+  /* Header over the external buffer, which is only read. */
+  insert(
+    Mat(
+      is_yuv420(format) ? (height + height / 2) : height,
+      width,
+      get_opencv_type(format),
+      const_cast<uint8_t*>(data),
+      stride
+    ),
+    format
+  );
+}
+
+/******************************************************************************/
+
+void LaBGen_P::insert_batch(const vector<Mat>& frames) {
+  if (!frames.empty())
+    insert_batch(frames, get_pixel_format(frames.front()));
+}
+
+/******************************************************************************/
+
+void LaBGen_P::insert_batch(const vector<Mat>& frames, PixelFormat format) {
+  if (frames.empty())
+    return;
+
+  for (const Mat& frame : frames)
+    check_frame(frame, format);
+
+  fix_color_space(format);
+
+  /* The first frame ever inserted only initializes the frame difference. */
+  size_t first = 0;
 
-  /* Initialization of background subtraction. */
   if (first_frame) {
+    compute_difference(frames[first++], format, motion_map);
     first_frame = false;
+  }
+
+  size_t batch_size = frames.size() - first;
+
+  if (batch_size == 0)
     return;
+
+  while (batch_quantities.size() < batch_size) {
+    batch_quantities.push_back(
+      Mat(quantities_of_motion.size(), quantities_of_motion.type())
+    );
   }
 
-  /* Filtering motion map to produce quantities of motion. */
-  filter.compute(motion_map, quantities_of_motion);
+  /* Quantities of motion of the whole batch. */
+  for (size_t k = 0; k < batch_size; ++k) {
+    compute_difference(frames[first + k], format, motion_map);
+    compute_quantities(motion_map, batch_quantities[k]);
+  }
 
-  /* Insert the current frame along with the quantities of motion into the
-   * history.
+  /* Insert the batch into the history pixel by pixel, so that each history
+   * gets all the samples of the batch while it is in cache.
    */
-  history.insert(quantities_of_motion, current_frame);
+  size_t changes = history->insert_batch(
+    batch_quantities.begin(),
+    frames.begin() + first,
+    batch_size,
+    format
+  );
+
+  if (motion_callback) {
+    for (size_t k = 0; k < batch_size; ++k)
+      motion_callback(batch_quantities[k]);
+  }
+
+  /* The quantities of motion of the last frame become the public ones. */
+  swap(quantities_of_motion, batch_quantities[batch_size - 1]);
+  count_inserted_frames(batch_size, changes);
+}
+
+/******************************************************************************/
+
+void LaBGen_P::insert_pair(const Mat& previous_frame, const Mat& frame) {
+  insert_pair(previous_frame, frame, get_pixel_format(frame));
+}
+
+/******************************************************************************/
+
+void LaBGen_P::insert_pair(
+  const Mat& previous_frame,
+  const Mat& frame,
+  PixelFormat format
+) {
+  check_frame(previous_frame, format);
+  check_frame(frame, format);
+  fix_color_space(format);
+
+  /* As the history keeps the best samples whatever their order, the pairs of
+   * consecutive frames can be inserted in any order. Only the second frame of
+   * a pair is inserted.
+   */
+  compute_difference(previous_frame, frame, format, motion_map);
+
+  first_frame = false;
+
+  compute_quantities(motion_map, quantities_of_motion);
+
+  size_t changes = history->insert(quantities_of_motion, frame, format);
+
+  if (motion_callback)
+    motion_callback(quantities_of_motion);
+
+  count_inserted_frames(1, changes);
+}
+
+/******************************************************************************/
+
+void LaBGen_P::insert_precomputed(
+  const Mat& quantities,
+  const Mat& frame,
+  PixelFormat format
+) {
+  check_frame(frame, format);
+  check_quantities_of_motion(quantities);
+  fix_color_space(format);
+
+  /* The quantities of motion of a previous run, e.g. read from a cache, skip
+   * the frame difference and the filtering. The motion map is left as is.
+   */
+  first_frame = false;
+
+  quantities.copyTo(quantities_of_motion);
+
+  size_t changes = history->insert(quantities_of_motion, frame, format);
+
+  if (motion_callback)
+    motion_callback(quantities_of_motion);
+
+  count_inserted_frames(1, changes);
 }
 
 /******************************************************************************/
 
 void LaBGen_P::generate_background(Mat& background) const {
-  if (history.empty()) {
+  if ((history == nullptr) || history->empty()) {
+    throw runtime_error(
+      "Cannot generate the background with less than two inserted frames"
+    );
+  }
+
+  switch (color_space) {
+    case COLOR_SPACE_YUV: {
+      /* Only the background is converted to BGR. */
+      Mat yuv_background(height, width, CV_8UC3);
+      history->median(yuv_background, s);
+
+      Utils::yuv_to_bgr(yuv_background, background);
+      break;
+    }
+
+    case COLOR_SPACE_GRAY:
+      background.create(height, width, CV_8UC1);
+      history->median(background, s);
+      break;
+
+    case COLOR_SPACE_GRAY16:
+      background.create(height, width, CV_16UC1);
+      history->median(background, s);
+      break;
+
+    default:
+      background.create(height, width, CV_8UC3);
+      history->median(background, s);
+      break;
+  }
+}
+
+/******************************************************************************/
+
+void LaBGen_P::update_background(Mat& background) {
+  if ((history == nullptr) || history->empty()) {
     throw runtime_error(
       "Cannot generate the background with less than two inserted frames"
     );
   }
 
-  history.median(background, s);
+  /* The median is kept in the space of the history between the calls, so that
+   * only the pixels whose history was modified are computed again. A new
+   * buffer has to be computed entirely.
+   */
+  int type;
+
+  switch (history_color_space) {
+    case COLOR_SPACE_GRAY:
+      type = CV_8UC1;
+      break;
+
+    case COLOR_SPACE_GRAY16:
+      type = CV_16UC1;
+      break;
+
+    default:
+      type = CV_8UC3;
+      break;
+  }
+
+  const uchar* data = median_background.data;
+  median_background.create(height, width, type);
+
+  if (median_background.data != data)
+    history->median(median_background, s);
+  else
+    history->update_median(median_background, s);
+
+  if (color_space == COLOR_SPACE_YUV)
+    Utils::yuv_to_bgr(median_background, background);
+  else
+    median_background.copyTo(background);
+}
+
+/******************************************************************************/
+
+void LaBGen_P::set_publication_period(size_t period) {
+  publication_period = period;
+}
+
+/******************************************************************************/
+
+size_t LaBGen_P::get_publication_period() const {
+  return publication_period;
+}
+
+/******************************************************************************/
+
+void LaBGen_P::set_publication_callback(PublicationCallback callback) {
+  publication_callback = move(callback);
+}
+
+/******************************************************************************/
+
+void LaBGen_P::set_motion_callback(MotionCallback callback) {
+  motion_callback = move(callback);
+}
+
+/******************************************************************************/
+
+void LaBGen_P::publish_background() {
+  /* The buffer of an older snapshot is reused once its last reader released
+   * it. The deleter hands it over under the lock of the pool, so that the
+   * accesses of the readers happen before the buffer is written again.
+   */
+  unique_ptr<BackgroundSnapshot> buffer;
+
+  {
+    lock_guard<mutex> lock(snapshot_pool->mutex);
+    buffer = move(snapshot_pool->spare);
+  }
+
+  if (buffer == nullptr)
+    buffer.reset(new BackgroundSnapshot());
+
+  update_background(buffer->background);
+  buffer->epoch = ++epoch;
+  buffer->inserted_frames = inserted_frames;
+
+  shared_ptr<SnapshotPool> pool = snapshot_pool;
+
+  BackgroundSnapshotPtr snapshot(
+    buffer.release(),
+    [pool](const BackgroundSnapshot* released) {
+      unique_ptr<BackgroundSnapshot> owned(
+        const_cast<BackgroundSnapshot*>(released)
+      );
+
+      lock_guard<mutex> lock(pool->mutex);
+
+      if (pool->spare == nullptr)
+        pool->spare = move(owned);
+    }
+  );
+
+  /* Released out of the lock, as the deleter could take the pool one. */
+  BackgroundSnapshotPtr previous = snapshot;
+
+  {
+    lock_guard<mutex> lock(publication_mutex);
+    previous.swap(published_snapshot);
+  }
+
+  last_publication = inserted_frames;
+
+  if (publication_callback)
+    publication_callback(snapshot);
+}
+
+/******************************************************************************/
+
+LaBGen_P::BackgroundSnapshotPtr LaBGen_P::get_background_snapshot() const {
+  lock_guard<mutex> lock(publication_mutex);
+  return published_snapshot;
+}
+
+/******************************************************************************/
+
+void LaBGen_P::monitor_convergence(
+  size_t window,
+  double max_changes,
+  double max_motion
+) {
+  if (!first_frame) {
+    throw logic_error(
+      "The convergence must be monitored before inserting frames"
+    );
+  }
+
+  monitor = unique_ptr<ConvergenceMonitor>(
+    new ConvergenceMonitor(height * width, window, max_changes, max_motion)
+  );
+
+  converged = false;
+}
+
+/******************************************************************************/
+
+bool LaBGen_P::has_converged() const {
+  return converged;
+}
+
+/******************************************************************************/
+
+size_t LaBGen_P::get_changed_pixels() const {
+  return changed_pixels;
+}
+
+/******************************************************************************/
+
+size_t LaBGen_P::get_skipped_frames() const {
+  return skipped_frames;
+}
+
+/******************************************************************************/
+
+size_t LaBGen_P::get_reused_frames() const {
+  return reused_frames;
+}
+
+/******************************************************************************/
+
+size_t LaBGen_P::get_inserted_frames() const {
+  return inserted_frames;
 }
 
 /******************************************************************************/
@@ -104,6 +639,12 @@ int32_t LaBGen_P::get_n() const {
 
 /******************************************************************************/
 
+int32_t LaBGen_P::get_motion_scale() const {
+  return motion_scale;
+}
+
+/******************************************************************************/
+
 const Mat& LaBGen_P::get_motion_map() const {
   return motion_map;
 }
@@ -113,3 +654,339 @@ const Mat& LaBGen_P::get_motion_map() const {
 const Mat& LaBGen_P::get_quantities_of_motion() const {
   return quantities_of_motion;
 }
+
+/******************************************************************************/
+
+void LaBGen_P::check_frame(const Mat& frame, PixelFormat format) const {
+  /* The chroma planes of a 4:2:0 frame follow its luma rows. */
+  size_t rows = is_yuv420(format) ? (height + height / 2) : height;
+
+  if ((frame.rows != rows) || (frame.cols != width))
+    throw logic_error("The size of the frame does not match LaBGen-P's one");
+
+  if (frame.type() != get_opencv_type(format))
+    throw logic_error("The type of the frame does not match its pixel format");
+
+  if (is_yuv420(format) && ((height & 1) || (width & 1)))
+    throw logic_error("4:2:0 frames must have even dimensions");
+}
+
+/******************************************************************************/
+
+void LaBGen_P::fix_color_space(PixelFormat format) {
+  ColorSpace space = get_color_space(format);
+
+  if (color_space == COLOR_SPACE_NONE)
+    color_space = space;
+  else if (color_space != space) {
+    throw logic_error(
+      "Frames of different color spaces cannot be mixed in LaBGen-P"
+    );
+  }
+
+  /* The detector is allocated again only when the kind of frames changes
+   * between two sequences.
+   */
+  Detector required =
+    (color_space == COLOR_SPACE_BGR) ? detector : DETECTOR_C1L1;
+
+  if ((motion_detector == nullptr) || (allocated_detector != required)) {
+    allocated_detector = required;
+
+    switch (required) {
+      case DETECTOR_C3L1:
+        motion_detector = unique_ptr<MotionDetector>(
+          new FrameDifferenceC3L1(motion_scale)
+        );
+
+        break;
+
+      case DETECTOR_C3L2:
+        motion_detector = unique_ptr<MotionDetector>(
+          new FrameDifferenceC3L2(motion_scale)
+        );
+
+        break;
+
+      default:
+        motion_detector = unique_ptr<MotionDetector>(
+          new FrameDifferenceC1L1(motion_scale)
+        );
+
+        break;
+    }
+  }
+
+  /* A history kept by reset() is only reused for the same color space. */
+  if (history != nullptr) {
+    if (history_color_space == color_space)
+      return;
+
+    history.reset();
+  }
+
+  history_color_space = color_space;
+
+  /* The storage of the history depends on the color space. */
+  if (median_approximation) {
+    switch (color_space) {
+      case COLOR_SPACE_GRAY:
+        history = unique_ptr<HistoryStorage>(
+          new ApproximateHistory8UC1(height, width, s, motion_scale)
+        );
+
+        break;
+
+      case COLOR_SPACE_GRAY16:
+        history = unique_ptr<HistoryStorage>(
+          new ApproximateHistory16UC1(height, width, s, motion_scale)
+        );
+
+        break;
+
+      default:
+        history = unique_ptr<HistoryStorage>(
+          new ApproximateHistory8UC3(height, width, s, motion_scale)
+        );
+
+        break;
+    }
+
+    return;
+  }
+
+  switch (color_space) {
+    case COLOR_SPACE_GRAY:
+      history = unique_ptr<HistoryStorage>(
+        new PatchesHistory8UC1(Utils::getROIs(height, width), s, motion_scale)
+      );
+
+      break;
+
+    case COLOR_SPACE_GRAY16:
+      history = unique_ptr<HistoryStorage>(
+        new PatchesHistory16UC1(Utils::getROIs(height, width), s, motion_scale)
+      );
+
+      break;
+
+    default:
+      if (chroma_subsampling && (color_space == COLOR_SPACE_YUV)) {
+        history = unique_ptr<HistoryStorage>(
+          new SubsampledHistory(height, width, s, motion_scale)
+        );
+      }
+      else {
+        history = unique_ptr<HistoryStorage>(
+          new PatchesHistory8UC3(Utils::getROIs(height, width), s, motion_scale)
+        );
+      }
+
+      break;
+  }
+}
+
+/******************************************************************************/
+
+void LaBGen_P::check_quantities_of_motion(const Mat& quantities) const {
+  if (
+    (quantities.rows != quantities_of_motion.rows) ||
+    (quantities.cols != quantities_of_motion.cols)
+  ) {
+    throw logic_error(
+      "The quantities of motion must have the size of the motion map"
+    );
+  }
+
+  if (quantities.type() != filter.getOpenCVEncoding())
+    throw logic_error("The type of the quantities of motion is not supported");
+}
+
+/******************************************************************************/
+
+void LaBGen_P::compute_difference(
+  const Mat& frame,
+  PixelFormat format,
+  Mat& motion_map
+) {
+  if (motion_thresholding)
+    t_diff.compute(get_luma(frame, format), motion_mask);
+  else
+    motion_detector->compute(get_luma(frame, format), motion_map);
+}
+
+/******************************************************************************/
+
+void LaBGen_P::compute_difference(
+  const Mat& previous_frame,
+  const Mat& frame,
+  PixelFormat format,
+  Mat& motion_map
+) {
+  if (motion_thresholding) {
+    t_diff.compute(
+      get_luma(previous_frame, format),
+      get_luma(frame, format),
+      motion_mask
+    );
+  }
+  else {
+    motion_detector->compute(
+      get_luma(previous_frame, format),
+      get_luma(frame, format),
+      motion_map
+    );
+  }
+}
+
+/******************************************************************************/
+
+void LaBGen_P::compute_quantities(Mat& motion_map, Mat& quantities) {
+  /* The motion mask is the one of the last difference. */
+  if (motion_thresholding)
+    mask_filter.compute(motion_mask, quantities);
+  else
+    filter.compute(motion_map, quantities);
+}
+
+/******************************************************************************/
+
+LaBGen_P::Repetition LaBGen_P::check_repetition(const Mat& frame) {
+  if (!duplicates_skipping)
+    return REPETITION_NONE;
+
+  signature.compute(frame);
+
+  /* Duplicates are compared with the previous frame, and near duplicates
+   * with the last frame whose motion was computed, so that a slow change
+   * cannot be skipped frame after frame.
+   */
+  bool first = reference_signature.empty();
+  Repetition repetition = REPETITION_NONE;
+
+  if (!first && (signature.get_hash() == previous_hash))
+    repetition = REPETITION_EXACT;
+  else if (
+    reusable_quantities &&
+    (duplicate_tolerance > 0) &&
+    (signature.distance(reference_signature) <= duplicate_tolerance)
+  ) {
+    repetition = REPETITION_NEAR;
+  }
+
+  previous_hash = signature.get_hash();
+
+  switch (repetition) {
+    case REPETITION_EXACT:
+      ++skipped_frames;
+
+      break;
+
+    case REPETITION_NEAR:
+      ++reused_frames;
+
+      break;
+
+    default:
+      /* The quantities of motion of the first frame are never computed. */
+      reusable_quantities = !first;
+      swap(signature, reference_signature);
+
+      break;
+  }
+
+  return repetition;
+}
+
+/******************************************************************************/
+
+void LaBGen_P::count_inserted_frames(size_t count, size_t changes) {
+  inserted_frames += count;
+  changed_pixels = changes;
+
+  /* The background is checked by the inserting thread at the end of each
+   * window, in a buffer kept between the checks.
+   */
+  if ((monitor != nullptr) && monitor->update(count, changes)) {
+    update_background(convergence_background);
+    monitor->check(convergence_background);
+
+    converged = monitor->has_converged();
+  }
+
+  /* Publication at the requested cadence, by the inserting thread. */
+  size_t period = publication_period;
+
+  if ((period != 0) && (inserted_frames - last_publication >= period))
+    publish_background();
+}
+
+/******************************************************************************/
+
+Mat LaBGen_P::get_luma(const Mat& frame, PixelFormat format) const {
+  /* The Y plane of a 4:2:0 frame is used as is by the frame difference. */
+  return is_yuv420(format) ? frame.rowRange(0, height) : frame;
+}
+
+/******************************************************************************/
+
+int LaBGen_P::get_opencv_type(PixelFormat format) {
+  switch (format) {
+    case PixelFormat::BGR24:
+      return CV_8UC3;
+
+    case PixelFormat::BGRA32:
+      return CV_8UC4;
+
+    case PixelFormat::I420:
+    case PixelFormat::NV12:
+    case PixelFormat::GRAY8:
+      return CV_8UC1;
+
+    case PixelFormat::GRAY16:
+      return CV_16UC1;
+  }
+
+  throw logic_error("Unknown pixel format");
+}
+
+/******************************************************************************/
+
+PixelFormat LaBGen_P::get_pixel_format(const Mat& frame) {
+  switch (frame.type()) {
+    case CV_8UC3:
+      return PixelFormat::BGR24;
+
+    case CV_8UC4:
+      return PixelFormat::BGRA32;
+
+    case CV_8UC1:
+      return PixelFormat::GRAY8;
+
+    case CV_16UC1:
+      return PixelFormat::GRAY16;
+  }
+
+  throw logic_error(
+    "The frame must be a BGR or BGRA 8-bit image, or a gray 8-bit or 16-bit one"
+  );
+}
+
+/******************************************************************************/
+
+LaBGen_P::ColorSpace LaBGen_P::get_color_space(PixelFormat format) {
+  switch (format) {
+    case PixelFormat::I420:
+    case PixelFormat::NV12:
+      return COLOR_SPACE_YUV;
+
+    case PixelFormat::GRAY8:
+      return COLOR_SPACE_GRAY;
+
+    case PixelFormat::GRAY16:
+      return COLOR_SPACE_GRAY16;
+
+    default:
+      return COLOR_SPACE_BGR;
+  }
+}
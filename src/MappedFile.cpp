@@ -0,0 +1,109 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <labgen-p/MappedFile.hpp>
+
+using namespace std;
+using namespace ns_labgen_p::ns_internals;
+
+/* ========================================================================== *
+ * MappedFile                                                                 *
+ * ========================================================================== */
+
+MappedFile::MappedFile(const string& path) :
+path(path),
+data(nullptr),
+size(0) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+
+  if (fd < 0)
+    throw runtime_error("Cannot open the '" + path + "' file.");
+
+  struct stat properties;
+
+  if (fstat(fd, &properties) != 0) {
+    ::close(fd);
+    throw runtime_error("Cannot get the size of the '" + path + "' file.");
+  }
+
+  size = properties.st_size;
+
+  if (size > 0) {
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+    if (mapping == MAP_FAILED) {
+      ::close(fd);
+      throw runtime_error("Cannot map the '" + path + "' file in memory.");
+    }
+
+    data = static_cast<const uint8_t*>(mapping);
+  }
+
+  /* The mapping remains valid once the descriptor is closed. */
+  ::close(fd);
+}
+
+/******************************************************************************/
+
+MappedFile::~MappedFile() {
+  if (data != nullptr)
+    munmap(const_cast<uint8_t*>(data), size);
+}
+
+/******************************************************************************/
+
+const uint8_t* MappedFile::get_data() const {
+  return data;
+}
+
+/******************************************************************************/
+
+size_t MappedFile::get_size() const {
+  return size;
+}
+
+/******************************************************************************/
+
+void MappedFile::advise_sequential() const {
+  if (data != nullptr)
+    madvise(const_cast<uint8_t*>(data), size, MADV_SEQUENTIAL);
+}
+
+/******************************************************************************/
+
+void MappedFile::advise_will_need(size_t offset, size_t length) const {
+  if ((data == nullptr) || (offset >= size))
+    return;
+
+  /* The advised range must start on a page boundary. */
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t begin = offset - (offset % page_size);
+  size_t end = min(offset + length, size);
+
+  madvise(const_cast<uint8_t*>(data) + begin, end - begin, MADV_WILLNEED);
+}
@@ -0,0 +1,143 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <stdexcept>
+
+#include <labgen-p/MaskQuantitiesMotion.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p::ns_internals;
+
+/* ========================================================================== *
+ * MaskQuantitiesMotion                                                       *
+ * ========================================================================== */
+
+MaskQuantitiesMotion::MaskQuantitiesMotion(int size) : size(size) {}
+
+/******************************************************************************/
+
+void MaskQuantitiesMotion::compute(
+  const MotionMask& motion_mask,
+  Mat& quantities_of_motion
+) {
+  if ((size / 2) == 0)
+    throw logic_error("Size divided by 2 is zero!");
+
+  int half = size / 2;
+  int rows = motion_mask.get_rows();
+  int cols = motion_mask.get_cols();
+  size_t words = motion_mask.get_words_per_row();
+
+  row_counts.resize(rows);
+
+  for (int y = 0; y < rows; ++y) {
+    const MotionMask::Word* mask_buffer = motion_mask.ptr(y);
+    int32_t count = 0;
+
+    for (size_t w = 0; w < words; ++w)
+      count += MotionMask::popcount(mask_buffer[w]);
+
+    row_counts[y] = count;
+  }
+
+  /* Window of the first row. */
+  column_counts.assign(cols, 0);
+  column_prefix.resize(cols + 1);
+  int32_t window_count = 0;
+
+  for (int y = 0; y <= min(half, rows - 1); ++y) {
+    accumulate_row(motion_mask, y, 1);
+    window_count += row_counts[y];
+  }
+
+  for (int y = 0; y < rows; ++y) {
+    int32_t* quantities_buffer = quantities_of_motion.ptr<int32_t>(y);
+
+    if (window_count == 0)
+      fill(quantities_buffer, quantities_buffer + cols, 0);
+    else
+      sum_columns(quantities_buffer);
+
+    /* The window slides down by one row. */
+    if ((y + half + 1) < rows) {
+      accumulate_row(motion_mask, y + half + 1, 1);
+      window_count += row_counts[y + half + 1];
+    }
+
+    if ((y - half) >= 0) {
+      accumulate_row(motion_mask, y - half, -1);
+      window_count -= row_counts[y - half];
+    }
+  }
+}
+
+/******************************************************************************/
+
+int MaskQuantitiesMotion::getOpenCVEncoding() const {
+  return CV_32SC1;
+}
+
+/******************************************************************************/
+
+void MaskQuantitiesMotion::accumulate_row(
+  const MotionMask& motion_mask,
+  int row,
+  int32_t sign
+) {
+  if (row_counts[row] == 0)
+    return;
+
+  const MotionMask::Word* mask_buffer = motion_mask.ptr(row);
+  int cols = motion_mask.get_cols();
+
+  for (size_t w = 0; w < motion_mask.get_words_per_row(); ++w) {
+    MotionMask::Word word = mask_buffer[w];
+
+    if (word == 0)
+      continue;
+
+    int first = w * MotionMask::WORD_BITS;
+    int count = min(MotionMask::WORD_BITS, cols - first);
+    int32_t* counts_buffer = column_counts.data() + first;
+
+    for (int b = 0; b < count; ++b)
+      counts_buffer[b] += sign * static_cast<int32_t>((word >> b) & 1);
+  }
+}
+
+/******************************************************************************/
+
+void MaskQuantitiesMotion::sum_columns(int32_t* quantities_buffer) {
+  int half = size / 2;
+  int cols = column_counts.size();
+
+  column_prefix[0] = 0;
+
+  for (int x = 0; x < cols; ++x)
+    column_prefix[x + 1] = column_prefix[x] + column_counts[x];
+
+  for (int x = 0; x < cols; ++x) {
+    quantities_buffer[x] =
+      column_prefix[min(x + half, cols - 1) + 1] -
+      column_prefix[max(x - half, 0)];
+  }
+}
@@ -0,0 +1,306 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <labgen-p/MotionCache.hpp>
+#include <labgen-p/Utils.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+using namespace ns_labgen_p::ns_internals;
+
+/* ========================================================================== *
+ * MotionCache                                                                *
+ * ========================================================================== */
+
+const char MotionCache::MAGIC[8] = {'L', 'B', 'G', 'P', 'Q', 'O', 'M', '1'};
+
+/******************************************************************************/
+
+MotionCache::Header MotionCache::make_header(const Key& key) {
+  Header header;
+  memset(&header, 0, sizeof(Header));
+
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.byte_order = ENDIANNESS;
+  header.height = key.height;
+  header.width = key.width;
+  header.n = key.n;
+  header.motion_scale = key.motion_scale;
+  header.motion_threshold = key.motion_threshold;
+  header.detector = key.detector;
+  header.format = static_cast<int32_t>(key.format);
+  header.rows = Utils::scaled_size(key.height, key.motion_scale);
+  header.cols = Utils::scaled_size(key.width, key.motion_scale);
+
+  return header;
+}
+
+/******************************************************************************/
+
+void MotionCache::encode(const Mat& quantities, vector<uint8_t>& buffer) {
+  buffer.clear();
+  int32_t previous = 0;
+
+  for (int y = 0; y < quantities.rows; ++y) {
+    const int32_t* qt_buffer = quantities.ptr<int32_t>(y);
+
+    for (int x = 0; x < quantities.cols; ++x) {
+      /* Zigzag encoding, so that the small negative differences are small
+       * unsigned integers as well.
+       */
+      int64_t delta = static_cast<int64_t>(qt_buffer[x]) - previous;
+      uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^
+                        static_cast<uint64_t>(delta >> 63);
+
+      previous = qt_buffer[x];
+
+      while (zigzag >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(zigzag | 0x80));
+        zigzag >>= 7;
+      }
+
+      buffer.push_back(static_cast<uint8_t>(zigzag));
+    }
+  }
+}
+
+/******************************************************************************/
+
+bool MotionCache::decode(const uint8_t* data, size_t size, Mat& quantities) {
+  const uint8_t* end = data + size;
+  int32_t previous = 0;
+
+  for (int y = 0; y < quantities.rows; ++y) {
+    int32_t* qt_buffer = quantities.ptr<int32_t>(y);
+
+    for (int x = 0; x < quantities.cols; ++x) {
+      uint64_t zigzag = 0;
+      size_t shift = 0;
+
+      do {
+        if ((data == end) || (shift > 63))
+          return false;
+
+        zigzag |= static_cast<uint64_t>(*data & 0x7F) << shift;
+        shift += 7;
+      } while (*(data++) & 0x80);
+
+      int64_t delta =
+        static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+
+      previous = static_cast<int32_t>(previous + delta);
+      qt_buffer[x] = previous;
+    }
+  }
+
+  return data == end;
+}
+
+/* ========================================================================== *
+ * MotionCacheReader                                                          *
+ * ========================================================================== */
+
+MotionCacheReader::MotionCacheReader(const string& path) :
+path(path),
+mapping(new MappedFile(path)) {
+  memcpy(&header, mapping->get_data(), sizeof(Header));
+  mapping->advise_sequential();
+}
+
+/******************************************************************************/
+
+size_t MotionCacheReader::get_frames_count() const {
+  return header.frames;
+}
+
+/******************************************************************************/
+
+uint64_t MotionCacheReader::get_frame_hash(size_t frame) const {
+  return get_index_entry(header.frames + frame);
+}
+
+/******************************************************************************/
+
+void MotionCacheReader::read(size_t frame, Mat& quantities) const {
+  if ((frame == 0) || (frame >= header.frames))
+    throw logic_error("The frame has no quantities of motion in the cache!");
+
+  uint64_t begin = get_index_entry(frame);
+  uint64_t end = (frame + 1 < header.frames) ?
+    get_index_entry(frame + 1) : header.index_offset;
+
+  quantities.create(header.rows, header.cols, CV_32SC1);
+
+  if (
+    (begin > end) ||
+    (end > header.index_offset) ||
+    !decode(mapping->get_data() + begin, end - begin, quantities)
+  ) {
+    throw runtime_error("The motion cache '" + path + "' is corrupted.");
+  }
+}
+
+/******************************************************************************/
+
+unique_ptr<MotionCacheReader> MotionCacheReader::open(
+  const string& path,
+  const Key& key
+) {
+  /* A missing cache is not an error, as it is written by the current run. */
+  ifstream probe(path.c_str(), ios::binary | ios::ate);
+
+  if (!probe || (static_cast<size_t>(probe.tellg()) < sizeof(Header)))
+    return nullptr;
+
+  probe.close();
+
+  unique_ptr<MotionCacheReader> reader(new MotionCacheReader(path));
+
+  const Header& header = reader->header;
+  Header expected = make_header(key);
+  size_t size = reader->mapping->get_size();
+
+  /* A cache of other frames or parameters is replaced by the current run. */
+  if (
+    (memcmp(header.magic, expected.magic, sizeof(MAGIC)) != 0) ||
+    (header.byte_order != expected.byte_order) ||
+    (header.height != expected.height) ||
+    (header.width != expected.width) ||
+    (header.n != expected.n) ||
+    (header.motion_scale != expected.motion_scale) ||
+    (header.motion_threshold != expected.motion_threshold) ||
+    (header.detector != expected.detector) ||
+    (header.format != expected.format) ||
+    (header.rows != expected.rows) ||
+    (header.cols != expected.cols) ||
+    (header.frames < 2) ||
+    (header.index_offset < sizeof(Header)) ||
+    (header.index_offset > size) ||
+    ((size - header.index_offset) / (2 * sizeof(uint64_t)) != header.frames)
+  ) {
+    return nullptr;
+  }
+
+  return reader;
+}
+
+/******************************************************************************/
+
+uint64_t MotionCacheReader::get_index_entry(size_t position) const {
+  /* The index is not necessarily aligned. */
+  uint64_t entry;
+  memcpy(
+    &entry,
+    mapping->get_data() + header.index_offset + position * sizeof(uint64_t),
+    sizeof(uint64_t)
+  );
+
+  return entry;
+}
+
+/* ========================================================================== *
+ * MotionCacheWriter                                                          *
+ * ========================================================================== */
+
+MotionCacheWriter::MotionCacheWriter(const string& path, const Key& key) :
+path(path),
+temporary_path(path + ".tmp"),
+output(temporary_path.c_str(), ios::binary | ios::trunc),
+header(make_header(key)),
+offsets(),
+position(sizeof(Header)),
+buffer(),
+committed(false) {
+  /* The header is written again once the index is known. */
+  output.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  check_output();
+
+  /* The first frame has no quantities of motion. */
+  offsets.push_back(position);
+}
+
+/******************************************************************************/
+
+MotionCacheWriter::~MotionCacheWriter() {
+  if (!committed) {
+    output.close();
+    remove(temporary_path.c_str());
+  }
+}
+
+/******************************************************************************/
+
+void MotionCacheWriter::append(const Mat& quantities) {
+  if ((quantities.rows != header.rows) || (quantities.cols != header.cols))
+    throw logic_error("The quantities of motion do not match the cache!");
+
+  encode(quantities, buffer);
+
+  offsets.push_back(position);
+  output.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  position += buffer.size();
+
+  check_output();
+}
+
+/******************************************************************************/
+
+void MotionCacheWriter::commit(const vector<uint64_t>& frame_hashes) {
+  if (frame_hashes.size() != offsets.size()) {
+    throw logic_error(
+      "The number of frames does not match the appended quantities of motion!"
+    );
+  }
+
+  header.frames = offsets.size();
+  header.index_offset = position;
+
+  output.write(
+    reinterpret_cast<const char*>(offsets.data()),
+    offsets.size() * sizeof(uint64_t)
+  );
+
+  output.write(
+    reinterpret_cast<const char*>(frame_hashes.data()),
+    frame_hashes.size() * sizeof(uint64_t)
+  );
+
+  output.seekp(0);
+  output.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  output.close();
+  check_output();
+
+  if (rename(temporary_path.c_str(), path.c_str()) != 0)
+    throw runtime_error("Cannot write the motion cache '" + path + "'.");
+
+  committed = true;
+}
+
+/******************************************************************************/
+
+void MotionCacheWriter::check_output() {
+  if (!output)
+    throw runtime_error("Cannot write the motion cache '" + path + "'.");
+}
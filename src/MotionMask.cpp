@@ -0,0 +1,79 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <labgen-p/MotionMask.hpp>
+
+using namespace ns_labgen_p::ns_internals;
+
+/* ========================================================================== *
+ * MotionMask                                                                 *
+ * ========================================================================== */
+
+const int MotionMask::WORD_BITS;
+
+/******************************************************************************/
+
+MotionMask::MotionMask() : rows(0), cols(0), words_per_row(0), words() {}
+
+/******************************************************************************/
+
+void MotionMask::create(int rows, int cols) {
+  this->rows = rows;
+  this->cols = cols;
+  words_per_row = (cols + WORD_BITS - 1) / WORD_BITS;
+
+  words.resize(rows * words_per_row);
+}
+
+/******************************************************************************/
+
+bool MotionMask::empty() const {
+  return words.empty();
+}
+
+/******************************************************************************/
+
+int MotionMask::get_rows() const {
+  return rows;
+}
+
+/******************************************************************************/
+
+int MotionMask::get_cols() const {
+  return cols;
+}
+
+/******************************************************************************/
+
+size_t MotionMask::get_words_per_row() const {
+  return words_per_row;
+}
+
+/******************************************************************************/
+
+MotionMask::Word* MotionMask::ptr(int row) {
+  return words.data() + (row * words_per_row);
+}
+
+/******************************************************************************/
+
+const MotionMask::Word* MotionMask::ptr(int row) const {
+  return words.data() + (row * words_per_row);
+}
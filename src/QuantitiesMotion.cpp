@@ -19,6 +19,7 @@
  * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <algorithm>
+#include <limits>
 #include <stdexcept>
 
 #include <labgen-p/QuantitiesMotion.hpp>
@@ -38,36 +39,77 @@ QuantitiesMotion::QuantitiesMotion(int size) : size(size) {}
 void QuantitiesMotion::compute(
   Mat& motion_map,
   Mat& quantities_of_motion
+) {
+  if ((size / 2) == 0)
+    throw logic_error("Size divided by 2 is zero!");
+
+  /* The whole image sum of a large motion map can overflow 32 bits, even if
+   * the sum of a window cannot.
+   */
+  if (requires_wide_sums(motion_map)) {
+    wide_sums.rebuild(motion_map);
+    compute_window_sums(wide_sums, motion_map, quantities_of_motion);
+  }
+  else {
+    sums.rebuild(motion_map);
+    compute_window_sums(sums, motion_map, quantities_of_motion);
+  }
+}
+
+/******************************************************************************/
+
+int QuantitiesMotion::getOpenCVEncoding() const {
+  return CV_32SC1;
+}
+
+/******************************************************************************/
+
+bool QuantitiesMotion::requires_wide_sums(const Mat& motion_map) const {
+  return
+    (static_cast<int64_t>(motion_map.total()) * MAX_MOTION) >
+    numeric_limits<QuantitiesMotionEncoding>::max();
+}
+
+/******************************************************************************/
+
+template <typename Sums>
+void QuantitiesMotion::compute_window_sums(
+  const Sums& sums,
+  const Mat& motion_map,
+  Mat& quantities_of_motion
 ) const {
   int half = size / 2;
+  int rows = motion_map.rows;
+  int cols = motion_map.cols;
 
-  if (half == 0)
-    throw logic_error("Size divided by 2 is zero!");
-
-  QuantitiesMotionEncoding* output_buffer =
-    reinterpret_cast<QuantitiesMotionEncoding*>(quantities_of_motion.data);
+  /* Columns whose kernel lies entirely in the image. */
+  int min_interior = min(half, cols);
+  int max_interior = max(cols - half, min_interior);
 
-  SummedAreaTables<QuantitiesMotionEncoding> sums(motion_map);
+  for (int y = 0; y < rows; ++y) {
+    QuantitiesMotionEncoding* output_buffer =
+      quantities_of_motion.ptr<QuantitiesMotionEncoding>(y);
 
-  for (int y = 0; y < motion_map.rows; ++y) {
-    for (int x = 0; x < motion_map.cols; ++x, ++output_buffer) {
-      /* Computing kernel ROI. */
-      int x_roi = max(x - half, 0);
-      int y_roi = max(y - half, 0);
-      int width_roi =
-        min(x + half, (motion_map.cols - 1)) - max(x - half, 0) + 1;
-      int height_roi =
-        min(y + half, (motion_map.rows - 1)) - max(y - half, 0) + 1;
+    /* Computing kernel ROI. */
+    int min_row = max(y - half, 0);
+    int max_row = min(y + half, rows - 1);
 
-      *output_buffer = sums.getIntegral(
-        y_roi, y_roi + height_roi - 1, x_roi, x_roi + width_roi - 1
+    for (int x = 0; x < min_interior; ++x) {
+      output_buffer[x] = sums.getIntegralUnchecked(
+        min_row, max_row, 0, min(x + half, cols - 1)
       );
     }
-  }
-}
 
-/******************************************************************************/
+    for (int x = min_interior; x < max_interior; ++x) {
+      output_buffer[x] = sums.getIntegralUnchecked(
+        min_row, max_row, x - half, x + half
+      );
+    }
 
-int QuantitiesMotion::getOpenCVEncoding() const {
-  return CV_32SC1;
+    for (int x = max_interior; x < cols; ++x) {
+      output_buffer[x] = sums.getIntegralUnchecked(
+        min_row, max_row, max(x - half, 0), cols - 1
+      );
+    }
+  }
 }
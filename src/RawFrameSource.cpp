@@ -0,0 +1,131 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdio>
+#include <stdexcept>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <labgen-p/RawFrameSource.hpp>
+#include <labgen-p/Utils.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+using namespace ns_labgen_p::ns_internals;
+
+/* ========================================================================== *
+ * RawFrameSource                                                             *
+ * ========================================================================== */
+
+RawFrameSource::RawFrameSource(
+  const string& input,
+  int32_t raw_height,
+  int32_t raw_width,
+  int reduction
+) :
+mapping(),
+raw_height(raw_height),
+raw_width(raw_width),
+reduction(reduction),
+height(Utils::scaled_size(raw_height, reduction)),
+width(Utils::scaled_size(raw_width, reduction)),
+frame_size(static_cast<size_t>(raw_height) * raw_width * 3),
+offset(0) {
+  if ((raw_height <= 0) || (raw_width <= 0))
+    throw logic_error("The size of raw frames must be positive");
+
+  if (input != "-") {
+    mapping = unique_ptr<MappedFile>(new MappedFile(input));
+    mapping->advise_sequential();
+  }
+}
+
+/******************************************************************************/
+
+bool RawFrameSource::read(Mat& frame) {
+  Mat raw;
+
+  if (mapping != nullptr) {
+    if (offset + frame_size > mapping->get_size())
+      return false;
+
+    mapping->advise_will_need(
+      offset + frame_size,
+      READAHEAD_FRAMES * frame_size
+    );
+
+    /* Header pointing into the mapping: no copy. */
+    raw = Mat(
+      raw_height,
+      raw_width,
+      CV_8UC3,
+      const_cast<uint8_t*>(mapping->get_data() + offset)
+    );
+  }
+  else {
+    raw = Mat(raw_height, raw_width, CV_8UC3);
+
+    if (fread(raw.data, 1, frame_size, stdin) != frame_size)
+      return false;
+  }
+
+  offset += frame_size;
+
+  if (reduction == 1)
+    frame = raw;
+  else
+    resize(raw, frame, Size(width, height), 0, 0, INTER_AREA);
+
+  return true;
+}
+
+/******************************************************************************/
+
+int32_t RawFrameSource::get_height() const {
+  return height;
+}
+
+/******************************************************************************/
+
+int32_t RawFrameSource::get_width() const {
+  return width;
+}
+
+/******************************************************************************/
+
+bool RawFrameSource::is_seekable() const {
+  return mapping != nullptr;
+}
+
+/******************************************************************************/
+
+size_t RawFrameSource::get_frames_count() const {
+  return (mapping != nullptr) ? (mapping->get_size() / frame_size) : 0;
+}
+
+/******************************************************************************/
+
+void RawFrameSource::seek(size_t index) {
+  if (mapping == nullptr)
+    throw logic_error("The standard input has no random access!");
+
+  offset = index * frame_size;
+}
@@ -0,0 +1,439 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <climits>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+#include <labgen-p/SharedFrameRing.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+
+/* The layout is shared with other processes: it must not depend on the
+ * compiler, and the atomics must not hide a lock. */
+static_assert(
+  sizeof(SharedFrameRing::Header) == SharedFrameRing::ALIGNMENT,
+  "The header of a shared frame ring must be 64 bytes long"
+);
+
+static_assert(
+  sizeof(SharedFrameRing::SlotHeader) == SharedFrameRing::ALIGNMENT,
+  "The header of a slot must be 64 bytes long"
+);
+
+static_assert(
+  (ATOMIC_INT_LOCK_FREE == 2) && (ATOMIC_LLONG_LOCK_FREE == 2),
+  "Shared frame rings require lock-free atomics"
+);
+
+/* ========================================================================== *
+ * SharedFrameRing                                                            *
+ * ========================================================================== */
+
+SharedFrameRing::SharedFrameRing(const string& name) :
+name(name),
+owner(false),
+base(nullptr),
+size(0),
+header(nullptr) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+
+  if (fd < 0)
+    throw runtime_error("Cannot open the '" + name + "' shared frame ring.");
+
+  struct stat properties;
+
+  if ((fstat(fd, &properties) != 0) ||
+      (static_cast<size_t>(properties.st_size) < sizeof(Header))) {
+    ::close(fd);
+    throw runtime_error("The '" + name + "' shared frame ring is not ready.");
+  }
+
+  size = properties.st_size;
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (mapping == MAP_FAILED)
+    throw runtime_error("Cannot map the '" + name + "' shared frame ring.");
+
+  base = static_cast<uint8_t*>(mapping);
+  header = reinterpret_cast<Header*>(base);
+
+  if ((header->magic.load(memory_order_acquire) != MAGIC) ||
+      (header->version != VERSION)) {
+    munmap(base, size);
+    throw runtime_error("The '" + name + "' shared frame ring is invalid.");
+  }
+
+  if (header->data_offset + header->slot_size * header->slot_count > size) {
+    munmap(base, size);
+    throw runtime_error("The '" + name + "' shared frame ring is truncated.");
+  }
+}
+
+/******************************************************************************/
+
+SharedFrameRing::SharedFrameRing(
+  const string& name,
+  int32_t height,
+  int32_t width,
+  PixelFormat format,
+  uint32_t slot_count
+) :
+name(name),
+owner(true),
+base(nullptr),
+size(0),
+header(nullptr) {
+  if ((height <= 0) || (width <= 0))
+    throw logic_error("The size of shared frames must be positive");
+
+  if (slot_count < 2)
+    throw logic_error("A shared frame ring requires at least two slots");
+
+  if (is_yuv420(format) && ((height & 1) || (width & 1)))
+    throw logic_error("4:2:0 shared frames must have even dimensions");
+
+  /* The chroma planes of a 4:2:0 frame follow its luma rows. */
+  size_t rows = is_yuv420(format) ? (height + height / 2) : height;
+  size_t frame_stride = align(width * get_pixel_size(format));
+  size_t slot_size = sizeof(SlotHeader) + frame_stride * rows;
+  size = sizeof(Header) + slot_size * slot_count;
+
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+
+  if (fd < 0)
+    throw runtime_error("Cannot create the '" + name + "' shared frame ring.");
+
+  if (ftruncate(fd, size) != 0) {
+    ::close(fd);
+    shm_unlink(name.c_str());
+    throw runtime_error("Cannot size the '" + name + "' shared frame ring.");
+  }
+
+  void* mapping = mmap(
+    nullptr,
+    size,
+    PROT_READ | PROT_WRITE,
+    MAP_SHARED,
+    fd,
+    0
+  );
+
+  ::close(fd);
+
+  if (mapping == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    throw runtime_error("Cannot map the '" + name + "' shared frame ring.");
+  }
+
+  base = static_cast<uint8_t*>(mapping);
+  header = new (base) Header();
+
+  header->version = VERSION;
+  header->height = height;
+  header->width = width;
+  header->format = format;
+  header->slot_count = slot_count;
+  header->frame_stride = frame_stride;
+  header->slot_size = slot_size;
+  header->data_offset = sizeof(Header);
+  header->published.store(0, memory_order_relaxed);
+  header->notification.store(0, memory_order_relaxed);
+  header->closed.store(0, memory_order_relaxed);
+
+  for (uint32_t i = 0; i < slot_count; ++i) {
+    SlotHeader* slot = new (get_slot(i)) SlotHeader();
+    slot->sequence.store(0, memory_order_relaxed);
+  }
+
+  /* Readers check the magic number before anything else. */
+  header->magic.store(MAGIC, memory_order_release);
+}
+
+/******************************************************************************/
+
+SharedFrameRing::~SharedFrameRing() {
+  if (owner) {
+    close();
+    shm_unlink(name.c_str());
+  }
+
+  munmap(base, size);
+}
+
+/******************************************************************************/
+
+void SharedFrameRing::publish(const Mat& frame) {
+  if (!owner)
+    throw logic_error("Only the producer can publish in a shared frame ring");
+
+  if ((frame.type() != get_opencv_type()) ||
+      (frame.rows != get_rows()) ||
+      (frame.cols != header->width)) {
+    throw logic_error("The frame does not match the shared frame ring");
+  }
+
+  uint64_t index = header->published.load(memory_order_relaxed);
+  SlotHeader* slot = get_slot(index);
+
+  /* Readers must not trust the slot while it is written. */
+  slot->sequence.store(2 * index + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  uint8_t* pixels = reinterpret_cast<uint8_t*>(slot + 1);
+  size_t row_size = frame.cols * frame.elemSize();
+
+  if (get_format() == PixelFormat::I420) {
+    /* The rows of the U and V planes are half the stride apart. */
+    for (int32_t y = 0; y < header->height; ++y)
+      memcpy(pixels + y * header->frame_stride, frame.ptr(y), row_size);
+
+    uint8_t* chroma = pixels + header->height * header->frame_stride;
+    const uint8_t* frame_chroma = frame.ptr(header->height);
+
+    for (int32_t y = 0; y < header->height; ++y) {
+      memcpy(
+        chroma + y * (header->frame_stride / 2),
+        frame_chroma + y * (frame.step / 2),
+        row_size / 2
+      );
+    }
+  }
+  else {
+    for (int32_t y = 0; y < frame.rows; ++y)
+      memcpy(pixels + y * header->frame_stride, frame.ptr(y), row_size);
+  }
+
+  slot->sequence.store(2 * index + 2, memory_order_release);
+  header->published.store(index + 1, memory_order_release);
+  header->notification.fetch_add(1, memory_order_release);
+
+#ifdef __linux__
+  syscall(
+    SYS_futex,
+    reinterpret_cast<uint32_t*>(&header->notification),
+    FUTEX_WAKE,
+    INT_MAX,
+    nullptr,
+    nullptr,
+    0
+  );
+#endif
+}
+
+/******************************************************************************/
+
+void SharedFrameRing::close() {
+  if (!owner)
+    throw logic_error("Only the producer can close a shared frame ring");
+
+  header->closed.store(1, memory_order_release);
+  header->notification.fetch_add(1, memory_order_release);
+
+#ifdef __linux__
+  syscall(
+    SYS_futex,
+    reinterpret_cast<uint32_t*>(&header->notification),
+    FUTEX_WAKE,
+    INT_MAX,
+    nullptr,
+    nullptr,
+    0
+  );
+#endif
+}
+
+/******************************************************************************/
+
+bool SharedFrameRing::view(uint64_t index, Mat& frame) const {
+  if (!holds(index))
+    return false;
+
+  /* Header pointing into the shared memory, to be copied by the caller. */
+  frame = Mat(
+    get_rows(),
+    header->width,
+    get_opencv_type(),
+    reinterpret_cast<uint8_t*>(get_slot(index) + 1),
+    header->frame_stride
+  );
+
+  return true;
+}
+
+/******************************************************************************/
+
+bool SharedFrameRing::holds(uint64_t index) const {
+  /* Pairs with the release fence of the producer, so that pixels read before
+   * this call were not being overwritten if the slot still holds the frame. */
+  atomic_thread_fence(memory_order_acquire);
+
+  return
+    get_slot(index)->sequence.load(memory_order_acquire) == 2 * index + 2;
+}
+
+/******************************************************************************/
+
+void SharedFrameRing::wait(uint64_t published, int32_t timeout_ms) const {
+  /* Taken before checking the counters, so that no wake-up is missed. */
+  uint32_t ticket = header->notification.load(memory_order_acquire);
+
+  if ((get_published() != published) || is_closed())
+    return;
+
+#ifdef __linux__
+  struct timespec timeout;
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_nsec = (timeout_ms % 1000) * 1000000L;
+
+  syscall(
+    SYS_futex,
+    reinterpret_cast<uint32_t*>(&header->notification),
+    FUTEX_WAIT,
+    ticket,
+    &timeout,
+    nullptr,
+    0
+  );
+#else
+  /* No futex: polling with a short sleep. */
+  (void) ticket;
+  this_thread::sleep_for(chrono::milliseconds(min(timeout_ms, 1)));
+#endif
+}
+
+/******************************************************************************/
+
+uint64_t SharedFrameRing::get_published() const {
+  return header->published.load(memory_order_acquire);
+}
+
+/******************************************************************************/
+
+bool SharedFrameRing::is_closed() const {
+  return header->closed.load(memory_order_acquire) != 0;
+}
+
+/******************************************************************************/
+
+int32_t SharedFrameRing::get_height() const {
+  return header->height;
+}
+
+/******************************************************************************/
+
+int32_t SharedFrameRing::get_width() const {
+  return header->width;
+}
+
+/******************************************************************************/
+
+PixelFormat SharedFrameRing::get_format() const {
+  return static_cast<PixelFormat>(header->format);
+}
+
+/******************************************************************************/
+
+uint32_t SharedFrameRing::get_slot_count() const {
+  return header->slot_count;
+}
+
+/******************************************************************************/
+
+SharedFrameRing::SlotHeader* SharedFrameRing::get_slot(uint64_t index) const {
+  return reinterpret_cast<SlotHeader*>(
+    base + header->data_offset +
+    (index % header->slot_count) * header->slot_size
+  );
+}
+
+/******************************************************************************/
+
+int32_t SharedFrameRing::get_rows() const {
+  return
+    is_yuv420(get_format()) ?
+    (header->height + header->height / 2) :
+    header->height;
+}
+
+/******************************************************************************/
+
+int SharedFrameRing::get_opencv_type() const {
+  switch (get_format()) {
+    case PixelFormat::BGRA32:
+      return CV_8UC4;
+
+    case PixelFormat::I420:
+    case PixelFormat::NV12:
+    case PixelFormat::GRAY8:
+      return CV_8UC1;
+
+    case PixelFormat::GRAY16:
+      return CV_16UC1;
+
+    default:
+      return CV_8UC3;
+  }
+}
+
+/******************************************************************************/
+
+size_t SharedFrameRing::get_pixel_size(PixelFormat format) {
+  switch (format) {
+    case PixelFormat::BGR24:
+      return 3;
+
+    case PixelFormat::BGRA32:
+      return 4;
+
+    case PixelFormat::I420:
+    case PixelFormat::NV12:
+    case PixelFormat::GRAY8:
+      return 1;
+
+    case PixelFormat::GRAY16:
+      return 2;
+  }
+
+  throw logic_error("Unknown pixel format");
+}
+
+/******************************************************************************/
+
+size_t SharedFrameRing::align(size_t size) {
+  return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
@@ -0,0 +1,154 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <labgen-p/SharedMemorySource.hpp>
+#include <labgen-p/Utils.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+
+/* ========================================================================== *
+ * SharedMemorySource                                                         *
+ * ========================================================================== */
+
+SharedMemorySource::SharedMemorySource(
+  const string& input,
+  int reduction,
+  bool native_yuv
+) :
+ring(get_ring_name(input)),
+reduction(reduction),
+convert_yuv(
+  is_yuv420(ring.get_format()) && (!native_yuv || (reduction > 1))
+),
+height(Utils::scaled_size(ring.get_height(), reduction)),
+width(Utils::scaled_size(ring.get_width(), reduction)),
+max_lag(max(ring.get_slot_count() / 2, 1u)),
+next(0),
+skipped_frames(0) {
+  /* Starting from the oldest frame that can still be read safely. */
+  uint64_t published = ring.get_published();
+
+  if (published > max_lag)
+    next = published - max_lag;
+}
+
+/******************************************************************************/
+
+bool SharedMemorySource::read(Mat& frame) {
+  for (;;) {
+    uint64_t published = ring.get_published();
+
+    if (next < published) {
+      if (published - next > max_lag) {
+        skipped_frames += published - max_lag - next;
+        next = published - max_lag;
+      }
+
+      Mat raw;
+
+      /* Otherwise, overwritten in the meantime: catching up. */
+      if (!ring.view(next, raw))
+        continue;
+
+      /* The frame is copied out of the slot, as the pipeline keeps it while
+       * the producer goes on.
+       */
+      Mat copy;
+
+      if (convert_yuv) {
+        cvtColor(
+          raw,
+          copy,
+          (ring.get_format() == PixelFormat::I420) ?
+            CV_YUV2BGR_I420 :
+            CV_YUV2BGR_NV12
+        );
+      }
+      else if (reduction == 1)
+        raw.copyTo(copy);
+      else
+        resize(raw, copy, Size(width, height), 0, 0, INTER_AREA);
+
+      /* Overwritten during the copy: the torn frame is dropped. */
+      if (!ring.holds(next)) {
+        ++skipped_frames;
+        ++next;
+
+        continue;
+      }
+
+      ++next;
+
+      if (convert_yuv && (reduction > 1))
+        resize(copy, frame, Size(width, height), 0, 0, INTER_AREA);
+      else
+        frame = copy;
+
+      return true;
+    }
+
+    if (ring.is_closed())
+      return false;
+
+    ring.wait(published, WAIT_TIMEOUT_MS);
+  }
+}
+
+/******************************************************************************/
+
+int32_t SharedMemorySource::get_height() const {
+  return height;
+}
+
+/******************************************************************************/
+
+int32_t SharedMemorySource::get_width() const {
+  return width;
+}
+
+/******************************************************************************/
+
+PixelFormat SharedMemorySource::get_pixel_format() const {
+  return convert_yuv ? PixelFormat::BGR24 : ring.get_format();
+}
+
+/******************************************************************************/
+
+uint64_t SharedMemorySource::get_skipped_frames() const {
+  return skipped_frames;
+}
+
+/******************************************************************************/
+
+bool SharedMemorySource::is_shared_memory(const string& input) {
+  return input.compare(0, 4, "shm:") == 0;
+}
+
+/******************************************************************************/
+
+string SharedMemorySource::get_ring_name(const string& input) {
+  return is_shared_memory(input) ? input.substr(4) : input;
+}
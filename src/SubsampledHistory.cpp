@@ -0,0 +1,273 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <labgen-p/SubsampledHistory.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+using namespace ns_labgen_p::ns_internals;
+
+/* ========================================================================== *
+ * SubsampledHistory                                                          *
+ * ========================================================================== */
+
+SubsampledHistory::SubsampledHistory(
+  size_t height,
+  size_t width,
+  size_t buffer_size,
+  int motion_scale
+) :
+height(height),
+width(width),
+buffer_size(buffer_size),
+motion_scale(motion_scale),
+luma_sizes(height * width, 0),
+luma_keys(height * width * buffer_size),
+luma_samples(height * width * buffer_size),
+chroma_sizes((height / 2) * (width / 2), 0),
+chroma_keys((height / 2) * (width / 2) * buffer_size),
+chroma_samples((height / 2) * (width / 2) * buffer_size * 2) {
+  if ((height & 1) || (width & 1))
+    throw logic_error("4:2:0 frames must have even dimensions");
+}
+
+/******************************************************************************/
+
+size_t SubsampledHistory::insert(
+  const Mat& quantities_of_motion,
+  const Mat& current_frame,
+  PixelFormat format
+) {
+  if (!is_yuv420(format))
+    throw logic_error("A subsampled history can only store 4:2:0 frames");
+
+  size_t changes = 0;
+
+  /* Luma, pixel by pixel. */
+  for (size_t y = 0; y < height; ++y) {
+    const uint8_t* luma_buffer = current_frame.ptr(y);
+    const int32_t* qt_buffer =
+      quantities_of_motion.ptr<int32_t>(y / motion_scale);
+
+    size_t pixel = y * width;
+
+    for (size_t x = 0; x < width; ++x, ++pixel) {
+      changes += insert_sample(
+        luma_keys.data() + pixel * buffer_size,
+        luma_samples.data() + pixel * buffer_size,
+        1,
+        luma_sizes[pixel],
+        qt_buffer[x / motion_scale],
+        luma_buffer + x
+      );
+    }
+  }
+
+  /* Chroma, block by block. */
+  const uint8_t* chroma_planes = current_frame.ptr(height);
+  size_t chroma_stride;
+  size_t chroma_step;
+  size_t v_offset;
+
+  if (format == PixelFormat::I420) {
+    chroma_stride = current_frame.step / 2;
+    chroma_step = 1;
+    v_offset = (height / 2) * chroma_stride;
+  }
+  else {
+    chroma_stride = current_frame.step;
+    chroma_step = 2;
+    v_offset = 1;
+  }
+
+  uint8_t sample[2];
+
+  for (size_t block_y = 0; block_y < height / 2; ++block_y) {
+    const uint8_t* u_buffer = chroma_planes + block_y * chroma_stride;
+    const int32_t* qt_top =
+      quantities_of_motion.ptr<int32_t>((2 * block_y) / motion_scale);
+    const int32_t* qt_bottom =
+      quantities_of_motion.ptr<int32_t>((2 * block_y + 1) / motion_scale);
+
+    size_t block = block_y * (width / 2);
+
+    for (size_t block_x = 0; block_x < width / 2; ++block_x, ++block) {
+      size_t left = (2 * block_x) / motion_scale;
+      size_t right = (2 * block_x + 1) / motion_scale;
+
+      uint64_t key_sum =
+        static_cast<uint64_t>(qt_top[left]) + qt_top[right] +
+        static_cast<uint64_t>(qt_bottom[left]) + qt_bottom[right];
+
+      sample[0] = u_buffer[block_x * chroma_step];
+      sample[1] = u_buffer[block_x * chroma_step + v_offset];
+
+      insert_sample(
+        chroma_keys.data() + block * buffer_size,
+        chroma_samples.data() + block * buffer_size * 2,
+        2,
+        chroma_sizes[block],
+        static_cast<uint32_t>((key_sum + 2) / 4),
+        sample
+      );
+    }
+  }
+
+  return changes;
+}
+
+/******************************************************************************/
+
+size_t SubsampledHistory::insert_batch(
+  MatIterator quantities_of_motion,
+  MatIterator current_frames,
+  size_t batch_size,
+  PixelFormat format
+) {
+  size_t changes = 0;
+
+  for (size_t k = 0; k < batch_size; ++k)
+    changes += insert(quantities_of_motion[k], current_frames[k], format);
+
+  return changes;
+}
+
+/******************************************************************************/
+
+void SubsampledHistory::median(Mat& result, size_t size) const {
+  vector<uint8_t> values(buffer_size);
+
+  /* Luma, in the first channel of the YUV result. */
+  for (size_t y = 0; y < height; ++y) {
+    uint8_t* result_buffer = result.ptr(y);
+    size_t pixel = y * width;
+
+    for (size_t x = 0; x < width; ++x, ++pixel, result_buffer += 3) {
+      size_t count = min<size_t>(luma_sizes[pixel], size);
+      const uint8_t* samples = luma_samples.data() + pixel * buffer_size;
+
+      copy(samples, samples + count, values.begin());
+      result_buffer[0] = median(values.data(), count);
+    }
+  }
+
+  /* Chroma, shared by the four pixels of a block. */
+  for (size_t block_y = 0; block_y < height / 2; ++block_y) {
+    uint8_t* top_buffer = result.ptr(2 * block_y);
+    uint8_t* bottom_buffer = result.ptr(2 * block_y + 1);
+    size_t block = block_y * (width / 2);
+
+    for (size_t block_x = 0; block_x < width / 2; ++block_x, ++block) {
+      size_t count = min<size_t>(chroma_sizes[block], size);
+      const uint8_t* samples =
+        chroma_samples.data() + block * buffer_size * 2;
+
+      for (size_t channel = 0; channel < 2; ++channel) {
+        for (size_t i = 0; i < count; ++i)
+          values[i] = samples[2 * i + channel];
+
+        uint8_t value = median(values.data(), count);
+        size_t offset = 6 * block_x + 1 + channel;
+
+        top_buffer[offset] = top_buffer[offset + 3] = value;
+        bottom_buffer[offset] = bottom_buffer[offset + 3] = value;
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+
+bool SubsampledHistory::empty() const {
+  return
+    find(luma_sizes.begin(), luma_sizes.end(), 0) != luma_sizes.end();
+}
+
+/******************************************************************************/
+
+void SubsampledHistory::clear() {
+  fill(luma_sizes.begin(), luma_sizes.end(), 0);
+  fill(chroma_sizes.begin(), chroma_sizes.end(), 0);
+}
+
+/******************************************************************************/
+
+bool SubsampledHistory::insert_sample(
+  uint32_t* keys,
+  uint8_t* samples,
+  size_t channels,
+  uint32_t& history_size,
+  uint32_t key,
+  const uint8_t* sample
+) const {
+  /* As with History, a sample goes before the ones with an equal key. */
+  uint32_t position = 0;
+
+  while ((position < history_size) && (key > keys[position]))
+    ++position;
+
+  if (position == buffer_size)
+    return false;
+
+  bool improved =
+    (history_size < buffer_size) || (key < keys[buffer_size - 1]);
+
+  /* The last sample of a full history is dropped. */
+  size_t moved =
+    min<size_t>(history_size, buffer_size - 1) - position;
+
+  memmove(keys + position + 1, keys + position, moved * sizeof(uint32_t));
+  memmove(
+    samples + (position + 1) * channels,
+    samples + position * channels,
+    moved * channels
+  );
+
+  keys[position] = key;
+  memcpy(samples + position * channels, sample, channels);
+
+  if (history_size < buffer_size)
+    ++history_size;
+
+  return improved;
+}
+
+/******************************************************************************/
+
+uint8_t SubsampledHistory::median(uint8_t* values, size_t size) {
+  size_t middle = size / 2;
+
+  nth_element(values, values + middle, values + size);
+
+  if (size & 1)
+    return values[middle];
+
+  /* Mean of the two middle values, the lower one being the largest value of
+   * the lower half.
+   */
+  uint8_t lower = *max_element(values, values + middle);
+
+  return (static_cast<int32_t>(lower) + values[middle]) / 2;
+}
@@ -0,0 +1,137 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstring>
+
+#include <labgen-p/ThresholdedFrameDifference.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p::ns_internals;
+
+/* ========================================================================== *
+ * ThresholdedFrameDifference                                                 *
+ * ========================================================================== */
+
+ThresholdedFrameDifference::ThresholdedFrameDifference(
+  int scale,
+  uint8_t threshold
+) :
+FrameDifferenceC1L1(scale),
+threshold(threshold) {}
+
+/******************************************************************************/
+
+void ThresholdedFrameDifference::compute(
+  const Mat& current_frame,
+  MotionMask& motion_mask
+) {
+  if (current_frame.empty())
+    return;
+
+  convert(current_frame);
+
+  if (previous_frame.empty()) {
+    converted_input.copyTo(previous_frame);
+    return;
+  }
+
+  motion_mask.create(converted_input.rows, converted_input.cols);
+
+  int cols = converted_input.cols;
+  size_t words = motion_mask.get_words_per_row();
+
+  /* The flags beyond the last column stay zero, as the unused bits. */
+  flags.assign(words * MotionMask::WORD_BITS, 0);
+
+  /* Locals, as the flags could alias the members otherwise. */
+  uint8_t* flags_buffer = flags.data();
+  uint8_t motion_threshold = threshold;
+
+  for (int y = 0; y < converted_input.rows; ++y) {
+    const uint8_t* current_buffer  = converted_input.ptr(y);
+    const uint8_t* previous_buffer = previous_frame.ptr(y);
+    MotionMask::Word* mask_buffer = motion_mask.ptr(y);
+
+    for (int x = 0; x < cols; ++x) {
+      uint8_t difference =
+        max(current_buffer[x], previous_buffer[x]) -
+        min(current_buffer[x], previous_buffer[x]);
+
+      flags_buffer[x] = difference > motion_threshold;
+    }
+
+    for (size_t w = 0; w < words; ++w)
+      mask_buffer[w] = pack(flags_buffer + (w * MotionMask::WORD_BITS));
+  }
+
+  converted_input.copyTo(previous_frame);
+}
+
+/******************************************************************************/
+
+void ThresholdedFrameDifference::compute(
+  const Mat& last_frame,
+  const Mat& current_frame,
+  MotionMask& motion_mask
+) {
+  if (last_frame.empty() || current_frame.empty())
+    return;
+
+  convert(last_frame);
+  converted_input.copyTo(previous_frame);
+
+  compute(current_frame, motion_mask);
+}
+
+/******************************************************************************/
+
+void ThresholdedFrameDifference::set_threshold(uint8_t threshold) {
+  this->threshold = threshold;
+}
+
+/******************************************************************************/
+
+uint8_t ThresholdedFrameDifference::get_threshold() const {
+  return threshold;
+}
+
+/******************************************************************************/
+
+MotionMask::Word ThresholdedFrameDifference::pack(
+  const uint8_t* flags_buffer
+) {
+  /* Gathers the lowest bits of 8 bytes into a single byte, the product of
+   * each bit landing in a distinct bit of the highest byte.
+   */
+  const uint64_t GATHER = 0x0102040810204080ULL;
+
+  MotionMask::Word word = 0;
+
+  for (int byte = 0; byte < MotionMask::WORD_BITS / 8; ++byte) {
+    uint64_t chunk;
+    memcpy(&chunk, flags_buffer + (byte * 8), sizeof(chunk));
+
+    word |= ((chunk * GATHER) >> 56) << (byte * 8);
+  }
+
+  return word;
+}
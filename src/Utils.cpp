@@ -18,6 +18,9 @@
  * You should have received a copy of the GNU General Public License
  * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <cstring>
+
 #include <labgen-p/Utils.hpp>
 
 using namespace std;
@@ -107,6 +110,12 @@ Utils::ROIs Utils::getROIs(size_t height, size_t width) {
 
 /****************************************************************************/
 
+int Utils::scaled_size(int size, int scale) {
+  return (size + scale - 1) / scale;
+}
+
+/****************************************************************************/
+
 void Utils::normalize_mat(Mat& input, double max) {
   normalize_mat(input, input, max);
 }
@@ -118,3 +127,116 @@ void Utils::normalize_mat(const Mat& input, Mat& output, double max) {
   minMaxLoc(input, 0, &max_value);
   input.convertTo(output, output.empty() ? -1 : output.type(), max / max_value);
 }
+
+/****************************************************************************/
+
+void Utils::yuv_to_bgr(const Mat& yuv, Mat& bgr) {
+  /* BT.601 with the video range, as the 4:2:0 conversions of cvtColor, so that
+   * the colors do not depend on the path taken by the frames. The weights are
+   * in fixed point with 20 bits.
+   */
+  const int32_t SHIFT  = 20;
+  const int32_t HALF   = 1 << (SHIFT - 1);
+  const int32_t Y_W    = 1220542;
+  const int32_t U_TO_B = 2116026;
+  const int32_t U_TO_G = -409993;
+  const int32_t V_TO_G = -852492;
+  const int32_t V_TO_R = 1673527;
+
+  bgr.create(yuv.rows, yuv.cols, CV_8UC3);
+
+  for (int y = 0; y < yuv.rows; ++y) {
+    const unsigned char* yuv_buffer = yuv.ptr(y);
+    unsigned char* bgr_buffer = bgr.ptr(y);
+
+    for (int x = 0; x < yuv.cols; ++x, yuv_buffer += 3, bgr_buffer += 3) {
+      int32_t luma = max(0, yuv_buffer[0] - 16) * Y_W + HALF;
+      int32_t u = yuv_buffer[1] - 128;
+      int32_t v = yuv_buffer[2] - 128;
+
+      bgr_buffer[0] = saturate_cast<uchar>((luma + U_TO_B * u) >> SHIFT);
+      bgr_buffer[1] =
+        saturate_cast<uchar>((luma + U_TO_G * u + V_TO_G * v) >> SHIFT);
+      bgr_buffer[2] = saturate_cast<uchar>((luma + V_TO_R * v) >> SHIFT);
+    }
+  }
+}
+
+/****************************************************************************/
+
+void Utils::bgr_to_yuv(const Mat& bgr, Mat& yuv) {
+  /* Inverse of yuv_to_bgr(), with the same range and precision. */
+  const int32_t SHIFT  = 20;
+  const int32_t HALF   = 1 << (SHIFT - 1);
+  const int32_t B_TO_Y = 102662;
+  const int32_t G_TO_Y = 528618;
+  const int32_t R_TO_Y = 269262;
+  const int32_t B_TO_U = 460551;
+  const int32_t G_TO_U = -305127;
+  const int32_t R_TO_U = -155424;
+  const int32_t B_TO_V = -74897;
+  const int32_t G_TO_V = -385654;
+  const int32_t R_TO_V = 460551;
+
+  yuv.create(bgr.rows, bgr.cols, CV_8UC3);
+
+  for (int y = 0; y < bgr.rows; ++y) {
+    const unsigned char* bgr_buffer = bgr.ptr(y);
+    unsigned char* yuv_buffer = yuv.ptr(y);
+
+    for (int x = 0; x < bgr.cols; ++x, bgr_buffer += 3, yuv_buffer += 3) {
+      int32_t b = bgr_buffer[0];
+      int32_t g = bgr_buffer[1];
+      int32_t r = bgr_buffer[2];
+
+      yuv_buffer[0] = saturate_cast<uchar>(
+        16 + ((B_TO_Y * b + G_TO_Y * g + R_TO_Y * r + HALF) >> SHIFT)
+      );
+      yuv_buffer[1] = saturate_cast<uchar>(
+        128 + ((B_TO_U * b + G_TO_U * g + R_TO_U * r + HALF) >> SHIFT)
+      );
+      yuv_buffer[2] = saturate_cast<uchar>(
+        128 + ((B_TO_V * b + G_TO_V * g + R_TO_V * r + HALF) >> SHIFT)
+      );
+    }
+  }
+}
+
+/****************************************************************************/
+
+void Utils::reduce_depth(const Mat& input, Mat& output) {
+  /* 65535 is mapped onto 255, thus 16-bit samples are divided by 257. */
+  input.convertTo(output, CV_8U, 1. / 257);
+}
+
+/******************************************************************************/
+
+uint64_t Utils::hash(const Mat& frame) {
+  /* FNV-1a over 64-bit words, which is enough to tell two frames apart. */
+  const uint64_t PRIME = 0x100000001B3ULL;
+
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  hash = (hash ^ static_cast<uint64_t>(frame.rows)) * PRIME;
+  hash = (hash ^ static_cast<uint64_t>(frame.cols)) * PRIME;
+  hash = (hash ^ static_cast<uint64_t>(frame.type())) * PRIME;
+
+  size_t row_size = frame.cols * frame.elemSize();
+
+  for (int y = 0; y < frame.rows; ++y) {
+    const uint8_t* buffer = frame.ptr(y);
+    size_t i = 0;
+
+    for (; i + sizeof(uint64_t) <= row_size; i += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, buffer + i, sizeof(uint64_t));
+
+      hash = (hash ^ word) * PRIME;
+      hash ^= hash >> 32;
+    }
+
+    for (; i < row_size; ++i)
+      hash = (hash ^ buffer[i]) * PRIME;
+  }
+
+  return hash;
+}
@@ -0,0 +1,87 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdexcept>
+
+#include <labgen-p/Utils.hpp>
+#include <labgen-p/VideoCaptureSource.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+
+/* ========================================================================== *
+ * VideoCaptureSource                                                         *
+ * ========================================================================== */
+
+VideoCaptureSource::VideoCaptureSource(const string& input, int reduction) :
+decoder(input),
+reduction(reduction) {
+  if (!decoder.isOpened())
+    throw runtime_error("Cannot open the '" + input + "' sequence.");
+
+  height = Utils::scaled_size(decoder.get(CV_CAP_PROP_FRAME_HEIGHT), reduction);
+  width  = Utils::scaled_size(decoder.get(CV_CAP_PROP_FRAME_WIDTH), reduction);
+
+  /* Only known for the files, and estimated from the duration by some
+   * containers.
+   */
+  double count = decoder.get(CV_CAP_PROP_FRAME_COUNT);
+  frames_count = (count > 0) ? static_cast<size_t>(count) : 0;
+}
+
+/******************************************************************************/
+
+VideoCaptureSource::~VideoCaptureSource() {
+  decoder.release();
+}
+
+/******************************************************************************/
+
+bool VideoCaptureSource::read(Mat& frame) {
+  if (reduction == 1)
+    return decoder.read(frame);
+
+  /* Video codecs cannot decode at a reduced size. */
+  if (!decoder.read(decoded))
+    return false;
+
+  resize(decoded, frame, Size(width, height), 0, 0, INTER_AREA);
+  return true;
+}
+
+/******************************************************************************/
+
+int32_t VideoCaptureSource::get_height() const {
+  return height;
+}
+
+/******************************************************************************/
+
+int32_t VideoCaptureSource::get_width() const {
+  return width;
+}
+
+/******************************************************************************/
+
+size_t VideoCaptureSource::get_frames_count() const {
+  return frames_count;
+}
+
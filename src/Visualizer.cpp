@@ -0,0 +1,325 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <labgen-p/TextProperties.hpp>
+#include <labgen-p/Utils.hpp>
+#include <labgen-p/Visualizer.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+
+/* Pause after a rendering on screen, in durations of this rendering. */
+static const int32_t RENDERING_PAUSE_FACTOR = 3;
+
+/* ========================================================================== *
+ * Visualizer                                                                 *
+ * ========================================================================== */
+
+Visualizer::Visualizer(
+  int32_t height,
+  int32_t width,
+  const ArgumentsHandler& args_h
+) :
+height(height),
+width(width),
+visualization(args_h.get_visualization()),
+split_vis(args_h.get_split_vis()),
+record(args_h.get_record()),
+record_path(args_h.get_record_path()),
+record_fps(args_h.get_record_fps()),
+v_height((args_h.get_v_height() > 0) ? args_h.get_v_height() : height),
+v_width((args_h.get_v_width() > 0) ? args_h.get_v_width() : width),
+keep_ratio(args_h.get_keep_ratio()),
+wait(args_h.get_wait()),
+rendered_frames(0),
+last_revision(0),
+last_epoch(0),
+reduced_epoch(0),
+closed(false),
+wait_for_key(false),
+failure(nullptr) {
+  rendering_thread = thread(&Visualizer::rendering_loop, this);
+}
+
+/******************************************************************************/
+
+Visualizer::~Visualizer() {
+  if (rendering_thread.joinable()) {
+    try {
+      finish();
+    }
+    catch (...) {}
+  }
+}
+
+/******************************************************************************/
+
+bool Visualizer::is_ready() const {
+  return !snapshots.is_pending();
+}
+
+/******************************************************************************/
+
+Visualizer::Snapshot& Visualizer::get_snapshot() {
+  return snapshots.get_back();
+}
+
+/******************************************************************************/
+
+void Visualizer::publish() {
+  /* The swap itself is lock-free, but the notification could be lost between
+   * the check of the rendering thread and its wait without the lock.
+   */
+  {
+    lock_guard<mutex> lock(rendering_mutex);
+    snapshots.publish();
+  }
+
+  published.notify_one();
+}
+
+/******************************************************************************/
+
+void Visualizer::finish(bool wait_for_key) {
+  {
+    lock_guard<mutex> lock(rendering_mutex);
+    closed = true;
+    this->wait_for_key = wait_for_key;
+  }
+
+  published.notify_one();
+  rendering_thread.join();
+
+  if (failure != nullptr)
+    rethrow_exception(failure);
+}
+
+/******************************************************************************/
+
+size_t Visualizer::get_rendered_frames() const {
+  return rendered_frames;
+}
+
+/******************************************************************************/
+
+void Visualizer::rendering_loop() {
+  try {
+    open();
+
+    for (;;) {
+      bool last;
+
+      {
+        unique_lock<mutex> lock(rendering_mutex);
+        published.wait(
+          lock,
+          [this] { return closed || snapshots.is_pending(); }
+        );
+
+        last = closed;
+      }
+
+      /* The last snapshot published before closing is still rendered. */
+      if (snapshots.update()) {
+        const Snapshot& snapshot = snapshots.get_front();
+
+        if (
+          (rendered_frames == 0)               ||
+          (snapshot.revision != last_revision) ||
+          (get_epoch(snapshot) != last_epoch)
+        ) {
+          render(snapshot);
+
+          last_revision = snapshot.revision;
+          last_epoch = get_epoch(snapshot);
+          ++rendered_frames;
+        }
+      }
+      else if (last)
+        break;
+    }
+
+    close();
+  }
+  catch (...) {
+    failure = current_exception();
+  }
+}
+
+/******************************************************************************/
+
+void Visualizer::open() {
+  if (split_vis)
+    return;
+
+  TextProperties::TextPropertiesPtr title_properties = nullptr;
+
+  if (record) {
+    title_properties = make_shared<TextProperties>(
+      TextProperties::Font::FONT_DUPLEX,
+      0.8
+    );
+  }
+  else
+    title_properties = make_shared<TextProperties>();
+
+  window = unique_ptr<GridWindow>(
+    new GridWindow("LaBGen-P", v_height, v_width, 2, 2, title_properties)
+  );
+
+  if (keep_ratio)
+    window->keep_ratio();
+
+  if (record) {
+    const Mat& buffer = window->get_buffer();
+
+    record_stream = unique_ptr<VideoWriter>(
+      new VideoWriter(
+        record_path,
+        CV_FOURCC('M','J','P','G'),
+        record_fps,
+        Size(buffer.cols, buffer.rows)
+      )
+    );
+  }
+}
+
+/******************************************************************************/
+
+void Visualizer::render(const Snapshot& snapshot) {
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  /* Native 4:2:0 frames are only converted to be displayed, and 16-bit images
+   * are reduced to 8 bits.
+   */
+  const Mat* input = &snapshot.input;
+
+  if (snapshot.format == PixelFormat::I420) {
+    cvtColor(snapshot.input, input_8u, CV_YUV2BGR_I420);
+    input = &input_8u;
+  }
+  else if (snapshot.format == PixelFormat::NV12) {
+    cvtColor(snapshot.input, input_8u, CV_YUV2BGR_NV12);
+    input = &input_8u;
+  }
+  else if (snapshot.input.depth() == CV_16U) {
+    Utils::reduce_depth(snapshot.input, input_8u);
+    input = &input_8u;
+  }
+
+  /* The background only changes with its epoch, and is only reduced again
+   * for a new one.
+   */
+  const Mat* background = nullptr;
+
+  if (snapshot.background != nullptr) {
+    background = &snapshot.background->background;
+
+    if (background->depth() == CV_16U) {
+      if (get_epoch(snapshot) != reduced_epoch) {
+        Utils::reduce_depth(*background, background_8u);
+        reduced_epoch = get_epoch(snapshot);
+      }
+
+      background = &background_8u;
+    }
+  }
+
+  snapshot.motion_map.convertTo(motion_map_8u, CV_8U);
+  normalized_qom.create(height, width, CV_8UC1);
+
+  Utils::normalize_mat(snapshot.quantities_of_motion, normalized_qom, 255.);
+
+  if (split_vis) {
+    imshow("Input video", *input);
+
+    if (background != nullptr)
+      imshow("LaBGen-P", *background);
+
+    imshow("Motion map", motion_map_8u);
+    imshow("Quantities of motion", normalized_qom);
+  }
+  else {
+    /* The tiles of the frame follow its revision, and the one of the
+     * background follows the epoch of the background.
+     */
+    window->display_if_changed(*input, 0, snapshot.revision);
+    window->put_title("Input video", 0);
+
+    if (background != nullptr)
+      window->display_if_changed(*background, 1, get_epoch(snapshot));
+
+    window->put_title("Background estimated by LaBGen-P", 1);
+
+    window->display_if_changed(motion_map_8u, 2, snapshot.revision);
+    window->put_title("Motion map", 2);
+
+    window->display_if_changed(normalized_qom, 3, snapshot.revision);
+    window->put_title("Quantities of motion", 3);
+
+    if (visualization)
+      window->refresh();
+
+    if (record)
+      *record_stream << window->get_buffer();
+  }
+
+  /* waitKey() keeps the windows responsive during the pause. */
+  if (visualization) {
+    int32_t pause = 0;
+
+    if (!record) {
+      pause = RENDERING_PAUSE_FACTOR * static_cast<int32_t>(
+        chrono::duration_cast<chrono::milliseconds>(
+          chrono::steady_clock::now() - start
+        ).count()
+      );
+    }
+
+    waitKey(max(wait, pause));
+  }
+}
+
+/******************************************************************************/
+
+uint64_t Visualizer::get_epoch(const Snapshot& snapshot) {
+  return (snapshot.background != nullptr) ? snapshot.background->epoch : 0;
+}
+
+/******************************************************************************/
+
+void Visualizer::close() {
+  if (visualization) {
+    if (wait_for_key)
+      waitKey(0);
+
+    destroyAllWindows();
+  }
+
+  if (record)
+    record_stream->release();
+}
@@ -0,0 +1,173 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <utility>
+
+#include <labgen-p/WorkStealingPool.hpp>
+
+using namespace std;
+using namespace ns_labgen_p::ns_internals;
+
+/* ========================================================================== *
+ * WorkStealingPool                                                           *
+ * ========================================================================== */
+
+WorkStealingPool::WorkStealingPool(size_t threads_count) :
+next_worker(0),
+queued(0),
+pending(0),
+stopping(false),
+failure(nullptr) {
+  if (threads_count == 0)
+    threads_count = max(thread::hardware_concurrency(), 1u);
+
+  for (size_t i = 0; i < threads_count; ++i)
+    workers.push_back(WorkerPtr(new Worker()));
+
+  for (size_t i = 0; i < threads_count; ++i)
+    threads.push_back(thread(&WorkStealingPool::run, this, i));
+}
+
+/******************************************************************************/
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  work_available.notify_all();
+
+  for (thread& t : threads)
+    t.join();
+}
+
+/******************************************************************************/
+
+void WorkStealingPool::submit(Task task) {
+  size_t index;
+
+  {
+    lock_guard<std::mutex> lock(mutex);
+    index = next_worker;
+    next_worker = (next_worker + 1) % workers.size();
+    ++pending;
+  }
+
+  {
+    lock_guard<std::mutex> lock(workers[index]->mutex);
+    workers[index]->tasks.push_back(move(task));
+  }
+
+  /* Counted once queued, so that a woken thread always finds it. */
+  {
+    lock_guard<std::mutex> lock(mutex);
+    ++queued;
+  }
+
+  work_available.notify_one();
+}
+
+/******************************************************************************/
+
+void WorkStealingPool::wait() {
+  unique_lock<std::mutex> lock(mutex);
+  all_done.wait(lock, [this] { return pending == 0; });
+
+  /* Report the first failure since the last wait, if any. */
+  if (failure != nullptr) {
+    exception_ptr error = failure;
+    failure = nullptr;
+
+    rethrow_exception(error);
+  }
+}
+
+/******************************************************************************/
+
+size_t WorkStealingPool::size() const {
+  return workers.size();
+}
+
+/******************************************************************************/
+
+void WorkStealingPool::run(size_t index) {
+  for (;;) {
+    {
+      unique_lock<std::mutex> lock(mutex);
+      work_available.wait(lock, [this] { return stopping || (queued > 0); });
+
+      if (queued == 0)
+        return;
+
+      /* The task is reserved before being looked for in the queues. */
+      --queued;
+    }
+
+    Task task;
+    exception_ptr error = nullptr;
+
+    while (!pop(index, task)) {}
+
+    try {
+      task();
+    }
+    catch (...) {
+      error = current_exception();
+    }
+
+    {
+      lock_guard<std::mutex> lock(mutex);
+      --pending;
+
+      if ((error != nullptr) && (failure == nullptr))
+        failure = error;
+    }
+
+    all_done.notify_all();
+  }
+}
+
+/******************************************************************************/
+
+bool WorkStealingPool::pop(size_t index, Task& task) {
+  /* The newest task of its own queue first, the oldest one of the others. */
+  for (size_t i = 0; i < workers.size(); ++i) {
+    Worker& worker = *workers[(index + i) % workers.size()];
+    lock_guard<std::mutex> lock(worker.mutex);
+
+    if (worker.tasks.empty())
+      continue;
+
+    if (i == 0) {
+      task = move(worker.tasks.back());
+      worker.tasks.pop_back();
+    }
+    else {
+      task = move(worker.tasks.front());
+      worker.tasks.pop_front();
+    }
+
+    return true;
+  }
+
+  return false;
+}
@@ -0,0 +1,370 @@
+/**
+ * Copyright - Benjamin Laugraud <blaugraud@ulg.ac.be> - 2017
+ * http://www.montefiore.ulg.ac.be/~blaugraud
+ * http://www.telecom.ulg.ac.be/labgen
+ *
+ * This file is part of LaBGen-P.
+ *
+ * LaBGen-P is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LaBGen-P is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LaBGen-P.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <labgen-p/Utils.hpp>
+#include <labgen-p/Y4MSource.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace ns_labgen_p;
+using namespace ns_labgen_p::ns_internals;
+
+/* ========================================================================== *
+ * Y4MSource                                                                  *
+ * ========================================================================== */
+
+Y4MSource::Y4MSource(const string& input, int reduction, bool native_yuv) :
+mapping(),
+raw_height(0),
+raw_width(0),
+chroma(CHROMA_420),
+reduction(reduction),
+native(false),
+height(0),
+width(0),
+frame_size(0),
+offset(0),
+frames_offset(0) {
+  if (input != "-") {
+    mapping = unique_ptr<MappedFile>(new MappedFile(input));
+    mapping->advise_sequential();
+  }
+
+  string header;
+
+  if (!read_line(header)) {
+    throw runtime_error(
+      "Cannot read the header of the '" + input + "' stream."
+    );
+  }
+
+  parse_header(header);
+  frames_offset = offset;
+
+  height = Utils::scaled_size(raw_height, reduction);
+  width  = Utils::scaled_size(raw_width, reduction);
+  native =
+    native_yuv && (chroma != CHROMA_444) && (reduction == 1);
+
+  if ((mapping == nullptr) && !native)
+    buffer.resize(frame_size);
+}
+
+/******************************************************************************/
+
+bool Y4MSource::read(Mat& frame) {
+  string frame_header;
+
+  if (!read_line(frame_header))
+    return false;
+
+  if (frame_header.compare(0, 5, "FRAME") != 0)
+    throw runtime_error("Invalid frame header in a Y4M stream.");
+
+  const uint8_t* data = nullptr;
+
+  if (mapping != nullptr) {
+    if (offset + frame_size > mapping->get_size())
+      return false;
+
+    data = mapping->get_data() + offset;
+    offset += frame_size;
+
+    mapping->advise_will_need(offset, READAHEAD_FRAMES * (frame_size + 6));
+  }
+  else if (native) {
+    /* A new buffer for each frame, as it is delivered as is. */
+    frame = Mat(frame_size / raw_width, raw_width, CV_8UC1);
+
+    return fread(frame.data, 1, frame_size, stdin) == frame_size;
+  }
+  else {
+    if (fread(buffer.data(), 1, frame_size, stdin) != frame_size)
+      return false;
+
+    data = buffer.data();
+  }
+
+  if (native) {
+    /* Header pointing into the mapping: no copy. */
+    frame = Mat(
+      frame_size / raw_width,
+      raw_width,
+      CV_8UC1,
+      const_cast<uint8_t*>(data)
+    );
+  }
+  else if (reduction == 1)
+    convert(data, frame);
+  else {
+    Mat converted;
+    convert(data, converted);
+
+    resize(converted, frame, Size(width, height), 0, 0, INTER_AREA);
+  }
+
+  return true;
+}
+
+/******************************************************************************/
+
+int32_t Y4MSource::get_height() const {
+  return height;
+}
+
+/******************************************************************************/
+
+int32_t Y4MSource::get_width() const {
+  return width;
+}
+
+/******************************************************************************/
+
+PixelFormat Y4MSource::get_pixel_format() const {
+  if (!native)
+    return PixelFormat::BGR24;
+
+  return (chroma == CHROMA_MONO) ? PixelFormat::GRAY8 : PixelFormat::I420;
+}
+
+/******************************************************************************/
+
+bool Y4MSource::is_seekable() const {
+  return mapping != nullptr;
+}
+
+/******************************************************************************/
+
+size_t Y4MSource::get_frames_count() const {
+  if (mapping == nullptr)
+    return 0;
+
+  index_frames();
+  return frame_offsets.size();
+}
+
+/******************************************************************************/
+
+void Y4MSource::seek(size_t index) {
+  if (mapping == nullptr)
+    throw logic_error("The standard input has no random access!");
+
+  index_frames();
+
+  /* Beyond the last frame, the next read fails. */
+  offset =
+    (index < frame_offsets.size()) ?
+    frame_offsets[index] : mapping->get_size();
+}
+
+/******************************************************************************/
+
+bool Y4MSource::is_y4m(const string& input) {
+  return
+    (input.size() >= 4) &&
+    (input.compare(input.size() - 4, 4, ".y4m") == 0);
+}
+
+/******************************************************************************/
+
+bool Y4MSource::read_line(string& line) {
+  line.clear();
+
+  if (mapping != nullptr) {
+    const uint8_t* begin = mapping->get_data() + offset;
+    const uint8_t* end = static_cast<const uint8_t*>(
+      memchr(begin, '\n', mapping->get_size() - offset)
+    );
+
+    if (end == nullptr)
+      return false;
+
+    line.assign(reinterpret_cast<const char*>(begin), end - begin);
+    offset += (end - begin) + 1;
+
+    return true;
+  }
+
+  for (int c = fgetc(stdin); c != '\n'; c = fgetc(stdin)) {
+    if (c == EOF)
+      return false;
+
+    line.push_back(static_cast<char>(c));
+  }
+
+  return true;
+}
+
+/******************************************************************************/
+
+void Y4MSource::parse_header(const string& header) {
+  istringstream tokens(header);
+  string token;
+
+  tokens >> token;
+
+  if (token != "YUV4MPEG2")
+    throw runtime_error("The input is not a YUV4MPEG2 stream.");
+
+  while (tokens >> token) {
+    switch (token[0]) {
+      case 'W':
+        raw_width = atoi(token.c_str() + 1);
+        break;
+
+      case 'H':
+        raw_height = atoi(token.c_str() + 1);
+        break;
+
+      case 'C': {
+        /* Only the 8-bit color spaces without alpha are supported, as the
+         * other ones (e.g. C444alpha or C420p10) have larger frames.
+         */
+        string space = token.substr(1);
+
+        if (
+          (space == "420")      ||
+          (space == "420jpeg")  ||
+          (space == "420mpeg2") ||
+          (space == "420paldv")
+        )
+          chroma = CHROMA_420;
+        else if (space == "444")
+          chroma = CHROMA_444;
+        else if (space == "mono")
+          chroma = CHROMA_MONO;
+        else
+          throw runtime_error("Unsupported Y4M color space: " + token);
+
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+
+  if ((raw_height <= 0) || (raw_width <= 0))
+    throw runtime_error("Invalid frame size in the Y4M header.");
+
+  size_t luma_size = static_cast<size_t>(raw_height) * raw_width;
+
+  switch (chroma) {
+    case CHROMA_420:
+      if ((raw_height & 1) || (raw_width & 1))
+        throw runtime_error("Y4M 4:2:0 streams must have even dimensions.");
+
+      frame_size = luma_size + luma_size / 2;
+      break;
+
+    case CHROMA_444:
+      frame_size = 3 * luma_size;
+      break;
+
+    case CHROMA_MONO:
+      frame_size = luma_size;
+      break;
+  }
+}
+
+/******************************************************************************/
+
+void Y4MSource::index_frames() const {
+  if (!frame_offsets.empty())
+    return;
+
+  const uint8_t* data = mapping->get_data();
+  size_t size = mapping->get_size();
+  size_t position = frames_offset;
+
+  /* Only the headers are read. A truncated last frame is left out, as read()
+   * would do.
+   */
+  while (position < size) {
+    const uint8_t* end = static_cast<const uint8_t*>(
+      memchr(data + position, '\n', size - position)
+    );
+
+    if (
+      (end == nullptr)              ||
+      (end - (data + position) < 5) ||
+      (memcmp(data + position, "FRAME", 5) != 0)
+    ) {
+      break;
+    }
+
+    size_t frame = (end - data) + 1;
+
+    if (frame + frame_size > size)
+      break;
+
+    frame_offsets.push_back(position);
+    position = frame + frame_size;
+  }
+}
+
+/******************************************************************************/
+
+void Y4MSource::convert(const uint8_t* data, Mat& frame) const {
+  uint8_t* planes = const_cast<uint8_t*>(data);
+  size_t luma_size = static_cast<size_t>(raw_height) * raw_width;
+
+  switch (chroma) {
+    case CHROMA_420: {
+      Mat yuv(raw_height + raw_height / 2, raw_width, CV_8UC1, planes);
+      cvtColor(yuv, frame, CV_YUV2BGR_I420);
+
+      break;
+    }
+
+    case CHROMA_444: {
+      vector<Mat> yuv_planes;
+      yuv_planes.push_back(Mat(raw_height, raw_width, CV_8UC1, planes));
+      yuv_planes.push_back(
+        Mat(raw_height, raw_width, CV_8UC1, planes + luma_size)
+      );
+      yuv_planes.push_back(
+        Mat(raw_height, raw_width, CV_8UC1, planes + 2 * luma_size)
+      );
+
+      /* Same video range as the 4:2:0 conversion. */
+      Mat yuv;
+      merge(yuv_planes, yuv);
+      Utils::yuv_to_bgr(yuv, frame);
+
+      break;
+    }
+
+    case CHROMA_MONO: {
+      Mat gray(raw_height, raw_width, CV_8UC1, planes);
+      cvtColor(gray, frame, CV_GRAY2BGR);
+
+      break;
+    }
+  }
+}